@@ -0,0 +1,366 @@
+/**
+ * Micro-benchmarks for the batch Fraction kernels.
+ * Build and run with: make bench && ./bench [elements]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "sources/AtomicFraction.hpp"
+#include "sources/Fraction.hpp"
+#include "sources/FractionBatch.hpp"
+#include "sources/FractionExecutor.hpp"
+#include "sources/FractionIO.hpp"
+#include "sources/FractionMath.hpp"
+#include "sources/FractionParallel.hpp"
+#include "sources/FractionReciprocal.hpp"
+#include "sources/FractionPipeline.hpp"
+#include "sources/FractionSort.hpp"
+#include "sources/FractionVector.hpp"
+#include "sources/NumaFractionArray.hpp"
+#include "sources/ShardedAccumulator.hpp"
+
+using namespace std;
+using namespace ariel;
+
+template <typename Func>
+static double seconds(Func func)
+{
+    auto start = chrono::steady_clock::now();
+    func();
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+static void report(const string &name, size_t count, double secs)
+{
+    cout << name << ": " << secs * 1e3 << " ms, " << static_cast<double>(count) / secs / 1e6 << " M/s" << endl;
+}
+
+// Small-term fractions, as in the typical workloads
+static vector<Fraction> random_fractions(size_t count, unsigned seed)
+{
+    mt19937 gen(seed);
+    uniform_int_distribution<int> num(-1000, 1000);
+    uniform_int_distribution<int> den(1, 1000);
+    vector<Fraction> out;
+    out.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        out.emplace_back(num(gen), den(gen));
+    }
+    return out;
+}
+
+static void bench_fraction_vector(size_t count)
+{
+    vector<Fraction> lhs = random_fractions(count, 1);
+    vector<Fraction> rhs = random_fractions(count, 2);
+    cout << "FractionVector (avx2: " << fraction_vector_uses_avx2() << ")" << endl;
+
+    vector<Fraction> aos(count);
+    report("  AoS operator+ loop", count, seconds([&]
+                                                  {
+        for (size_t i = 0; i < count; ++i)
+        {
+            aos[i] = lhs[i] + rhs[i];
+        } }));
+    report("  AoS operator* loop", count, seconds([&]
+                                                  {
+        for (size_t i = 0; i < count; ++i)
+        {
+            aos[i] = lhs[i] * rhs[i];
+        } }));
+
+    FractionVector col_a(lhs);
+    FractionVector col_b(rhs);
+    FractionVector out;
+    report("  SoA add", count, seconds([&]
+                                       { out = add(col_a, col_b); }));
+    report("  SoA mul", count, seconds([&]
+                                       { out = mul(col_a, col_b); }));
+    report("  SoA compare", count, seconds([&]
+                                           { compare(col_a, col_b); }));
+}
+
+static void bench_sort(size_t count)
+{
+    vector<Fraction> input = random_fractions(count, 3);
+    cout << "Sort" << endl;
+
+    vector<Fraction> values = input;
+    report("  std::sort operator<", count, seconds([&]
+                                                   { std::sort(values.begin(), values.end()); }));
+    values = input;
+    report("  std::sort exact_less", count, seconds([&]
+                                                    { std::sort(values.begin(), values.end(), exact_less); }));
+    values = input;
+    report("  ariel::sort", count, seconds([&]
+                                           { ariel::sort(values); }));
+    values = input;
+    report("  ariel::parallel_sort", count, seconds([&]
+                                                    { ariel::parallel_sort(values); }));
+}
+
+// Runs body(thread_index) on `threads` threads at once
+template <typename Body>
+static void run_threads(unsigned threads, Body body)
+{
+    vector<thread> pool;
+    for (unsigned i = 0; i < threads; ++i)
+    {
+        pool.emplace_back(body, i);
+    }
+    for (thread &worker : pool)
+    {
+        worker.join();
+    }
+}
+
+static void bench_shared_counter(size_t count)
+{
+    const unsigned threads = max(2U, thread::hardware_concurrency());
+    const size_t per_thread = count / threads;
+    const Fraction tick(1, 1000);
+    cout << "Shared counter (" << threads << " threads)" << endl;
+
+    // Wraps around before overflowing so every update does real work
+    const Fraction limit(1000000, 1);
+
+    Fraction locked;
+    mutex lock;
+    report("  mutex + operator+", per_thread * threads, seconds([&]
+                                                                { run_threads(threads, [&](unsigned /*index*/)
+                                                                              {
+        for (size_t i = 0; i < per_thread; ++i)
+        {
+            lock_guard<mutex> guard(lock);
+            locked = locked > limit ? Fraction() : locked + tick;
+        } }); }));
+
+    AtomicFraction shared;
+    report("  AtomicFraction::fetch_add", per_thread * threads, seconds([&]
+                                                                        { run_threads(threads, [&](unsigned /*index*/)
+                                                                                      {
+        for (size_t i = 0; i < per_thread; ++i)
+        {
+            if (!shared.fetch_add(tick))
+            {
+                shared.store(Fraction());
+            }
+        } }); }));
+
+    ShardedAccumulator sharded;
+    report("  ShardedAccumulator::add", per_thread * threads, seconds([&]
+                                                                      { run_threads(threads, [&](unsigned /*index*/)
+                                                                                    {
+        for (size_t i = 0; i < per_thread; ++i)
+        {
+            sharded.add(tick);
+        } }); }));
+    cout << "  sharded total " << sharded.read() << endl;
+}
+
+static void bench_batch_status(size_t count)
+{
+    vector<Fraction> lhs = random_fractions(count, 6);
+    vector<Fraction> rhs = random_fractions(count, 7);
+    vector<Fraction> out(count);
+    cout << "Batch with status bitmap" << endl;
+
+    size_t failed = 0;
+    report("  try/catch per element operator/", count, seconds([&]
+                                                                {
+        for (size_t i = 0; i < count; ++i)
+        {
+            try
+            {
+                out[i] = lhs[i] / rhs[i];
+            }
+            catch (const exception &)
+            {
+                out[i] = Fraction();
+                ++failed;
+            }
+        } }));
+    StatusBitmap status;
+    report("  div with StatusBitmap", count, seconds([&]
+                                                     { failed = div(lhs, rhs, out, status); }));
+    cout << "  failed elements " << failed << endl;
+}
+
+static void bench_pipeline(size_t count)
+{
+    ostringstream records;
+    for (const Fraction &value : random_fractions(count, 8))
+    {
+        records << value.getNumerator() << ' ' << value.getDenominator() << '\n';
+    }
+    const string text = records.str();
+    const Fraction scale(3, 7);
+    cout << "Parse -> compute -> format" << endl;
+
+    report("  serial operator>> / operator<<", count, seconds([&]
+                                                              {
+        istringstream in(text);
+        in >> nothrow_extract;
+        ostringstream out;
+        Fraction value;
+        while (in >> value)
+        {
+            out << value * scale << '\n';
+        } }));
+    PipelineStats stats;
+    report("  run_pipeline", count, seconds([&]
+                                            {
+        istringstream in(text);
+        ostringstream out;
+        stats = run_pipeline(in, out, [&](span<Fraction> batch)
+                             {
+            for (Fraction &value : batch)
+            {
+                value = value * scale;
+            } }); }));
+    cout << "  busy/blocked ms: parse " << stats.parse.busy_seconds * 1e3 << "/" << stats.parse.blocked_seconds * 1e3
+         << ", compute " << stats.compute.busy_seconds * 1e3 << "/" << stats.compute.blocked_seconds * 1e3
+         << ", format " << stats.format.busy_seconds * 1e3 << "/" << stats.format.blocked_seconds * 1e3 << endl;
+}
+
+static void bench_scan(size_t count)
+{
+    // Cumulative durations in ticks of 1/48000 s and 1/44100 s
+    vector<Fraction> ticks(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        ticks[i] = Fraction(1 + static_cast<int>(i % 3), i % 2 == 0 ? 48000 : 44100);
+    }
+    vector<Fraction> out(count);
+    cout << "Running totals" << endl;
+
+    // operator+ throws on the unreduced 7056000 * 44100 cross product, so the serial
+    // baseline uses checked_add, which reduces before the range check
+    report("  serial checked_add", count, seconds([&]
+                                                  {
+        Fraction running;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (!checked_add(running, ticks[i], running))
+            {
+                running = Fraction();
+            }
+            out[i] = running;
+        } }));
+    StatusBitmap status;
+    size_t failed = 0;
+    report("  parallel_inclusive_scan", count, seconds([&]
+                                                       { failed = parallel_inclusive_scan(ticks, out, status); }));
+    cout << "  overflowed elements " << failed << endl;
+}
+
+static void bench_reciprocals(size_t count)
+{
+    // Typical inputs: denominators up to 1000 with a shared factor to cancel
+    mt19937 gen(9);
+    uniform_int_distribution<int> num(-1000, 1000);
+    uniform_int_distribution<int> den(1, 1000);
+    uniform_int_distribution<int> factor(2, 12);
+    vector<int> nums(count);
+    vector<int> dens(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        int common = factor(gen);
+        nums[i] = num(gen) * common;
+        dens[i] = den(gen) * common;
+    }
+    vector<Fraction> out(count);
+    vector<char> text(Fraction::decimal_buffer_size(6));
+    cout << "Reduction (reciprocal bound " << reciprocal_bound() << ")" << endl;
+
+    for (uint32_t bound : {0U, DEFAULT_RECIPROCAL_BOUND})
+    {
+        set_reciprocal_bound(bound);
+        string suffix = bound == 0 ? " (hardware div)" : " (reciprocals)";
+        report("  Fraction(n, d)" + suffix, count, seconds([&]
+                                                            {
+            for (size_t i = 0; i < count; ++i)
+            {
+                out[i] = Fraction(nums[i], dens[i]);
+            } }));
+        size_t written = 0;
+        report("  to_decimal(6)" + suffix, count, seconds([&]
+                                                           {
+            for (size_t i = 0; i < count; ++i)
+            {
+                written += out[i].to_decimal(text.data(), 6);
+            } }));
+    }
+    set_reciprocal_bound(DEFAULT_RECIPROCAL_BOUND);
+}
+
+static void bench_numa(size_t count)
+{
+    NumaFractionArray numa(count);
+    vector<Fraction> plain(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        numa[i] = plain[i] = Fraction(1 + static_cast<int>(i % 3), 48000);
+    }
+    unsigned bound = 0;
+    for (size_t i = 0; i < numa.partitions(); ++i)
+    {
+        bound += numa.partition_info(i).bound ? 1U : 0U;
+    }
+    cout << "NUMA partitions (" << numa.partitions() << " workers, " << bound << " bound)" << endl;
+
+    StatusBitmap status;
+    report("  scan std::vector, threads", count, seconds([&]
+                                                         { parallel_inclusive_scan(plain, plain, status); }));
+    report("  scan NumaFractionArray, pinned", count, seconds([&]
+                                                              { parallel_inclusive_scan(numa.data(), numa.data(), status, numa.scheduler()); }));
+}
+
+static void bench_executor(size_t count)
+{
+    // Large terms are clustered at the front so a static split leaves one worker far behind
+    vector<Fraction> data = random_fractions(count, 4);
+    mt19937 gen(5);
+    uniform_int_distribution<int> large(1 << 28, INT32_MAX);
+    for (size_t i = 0; i < count / 8; ++i)
+    {
+        data[i] = Fraction(large(gen), large(gen));
+    }
+    FractionExecutor executor;
+    cout << "Executor (" << executor.thread_count() << " threads)" << endl;
+    report("  for_each_chunk re-reduce", count, seconds([&]
+                                                        { executor.for_each_chunk(span<Fraction>(data), 1024, [](span<Fraction> chunk)
+                                                                                  {
+        for (Fraction &value : chunk)
+        {
+            value = Fraction(value.getNumerator(), value.getDenominator());
+        } }); }));
+    ExecutorStats stats = executor.stats();
+    cout << "  tasks " << stats.tasks << ", steals " << stats.steals << ", "
+         << stats.items_per_second() / 1e6 << " M items/s" << endl;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t count = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1U << 22U;
+    bench_fraction_vector(count);
+    bench_sort(count);
+    bench_shared_counter(count);
+    bench_executor(count);
+    bench_batch_status(count);
+    bench_pipeline(count);
+    bench_scan(count);
+    bench_reciprocals(count);
+    bench_numa(count);
+}
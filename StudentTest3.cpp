@@ -0,0 +1,1494 @@
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <execution>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "doctest.h"
+#include "sources/AtomicFraction.hpp"
+#include "sources/DyadicFraction.hpp"
+#include "sources/Fraction.hpp"
+#include "sources/Fraction16.hpp"
+#include "sources/FixedDenomFraction.hpp"
+#include "sources/FractionBatch.hpp"
+#include "sources/FractionCache.hpp"
+#include "sources/FractionExecutor.hpp"
+#include "sources/FractionIndex.hpp"
+#include "sources/FractionIO.hpp"
+#include "sources/FractionIntern.hpp"
+#include "sources/FractionMap.hpp"
+#include "sources/FractionParallel.hpp"
+#include "sources/FractionReciprocal.hpp"
+#include "sources/FractionPipeline.hpp"
+#include "sources/FractionRing.hpp"
+#include "sources/FractionSort.hpp"
+#include "sources/FractionStats.hpp"
+#include "sources/FractionVector.hpp"
+#include "sources/NumaFractionArray.hpp"
+#include "sources/ShardedAccumulator.hpp"
+#include "sources/StickyFraction.hpp"
+
+using namespace std;
+using namespace ariel;
+
+TEST_SUITE("Non-throwing input tests")
+{
+    TEST_CASE("nothrow_extract sets failbit and keeps the fraction")
+    {
+        std::stringstream ss("3 0");
+        ss >> nothrow_extract;
+        Fraction frac{1, 2};
+        CHECK_NOTHROW(ss >> frac);
+        CHECK(ss.fail());
+        CHECK_EQ(frac, Fraction{1, 2});
+
+        ss.clear();
+        ss.str("abc 4");
+        CHECK_NOTHROW(ss >> frac);
+        CHECK(ss.fail());
+        CHECK_EQ(frac, Fraction{1, 2});
+
+        ss.clear();
+        ss.str("6 -8");
+        ss >> frac;
+        CHECK_FALSE(ss.fail());
+        CHECK_EQ(frac, Fraction{-3, 4});
+
+        ss.clear();
+        ss.str("1 -2147483648");
+        CHECK_NOTHROW(ss >> frac);
+        CHECK(ss.fail());
+        CHECK_EQ(frac, Fraction{-3, 4});
+
+        ss.clear();
+        ss.str("3 0");
+        ss >> throw_extract;
+        CHECK_THROWS_AS(ss >> frac, std::runtime_error);
+    }
+
+    TEST_CASE("Batch reader counts bad records and keeps going")
+    {
+        std::stringstream ss("1 2\n"
+                             "3 0\n"
+                             "\n"
+                             "x 5\n"
+                             "  -4 6  \n"
+                             "7 8 9\n"
+                             "+-5 2\n"
+                             "4 +-3\n"
+                             "+ 1 2\n"
+                             "+5 10\n");
+        std::vector<Fraction> out;
+        ReadStats stats = read_fractions(ss, out);
+        CHECK_EQ(stats.records, 3);
+        CHECK_EQ(stats.errors, 6);
+        REQUIRE_EQ(out.size(), 3);
+        CHECK_EQ(out[0], Fraction{1, 2});
+        CHECK_EQ(out[1], Fraction{-2, 3});
+        CHECK_EQ(out[2], Fraction{1, 2});
+    }
+
+    TEST_CASE("Batch reader skips values with no int form")
+    {
+        std::stringstream ss("1 2\n"
+                             "1 -2147483648\n"
+                             "-2147483648 -1\n"
+                             "3 4\n");
+        std::vector<Fraction> out;
+        ReadStats stats;
+        CHECK_NOTHROW(stats = read_fractions(ss, out));
+        CHECK_EQ(stats.records, 2);
+        CHECK_EQ(stats.errors, 2);
+        REQUIRE_EQ(out.size(), 2);
+        CHECK_EQ(out[1], Fraction{3, 4});
+    }
+}
+
+TEST_SUITE("Exact decimal parsing tests")
+{
+    TEST_CASE("Plain and scientific decimals")
+    {
+        CHECK_EQ(from_decimal("0.1"), Fraction{1, 10});
+        CHECK_EQ(from_decimal("-2.5"), Fraction{-5, 2});
+        CHECK_EQ(from_decimal("+42"), Fraction{42, 1});
+        CHECK_EQ(from_decimal(".75"), Fraction{3, 4});
+        CHECK_EQ(from_decimal("1.25e-3"), Fraction{1, 800});
+        CHECK_EQ(from_decimal("3E2"), Fraction{300, 1});
+        CHECK_EQ(from_decimal("1500000000000000000000e-21"), Fraction{3, 2});
+        CHECK_EQ(from_decimal("-0.000"), Fraction{0, 1});
+    }
+
+    TEST_CASE("Repeating decimals")
+    {
+        CHECK_EQ(from_decimal("0.(3)"), Fraction{1, 3});
+        CHECK_EQ(from_decimal("0.1(6)"), Fraction{1, 6});
+        CHECK_EQ(from_decimal("1.(142857)"), Fraction{8, 7});
+        CHECK_EQ(from_decimal("-0.0(9)"), Fraction{-1, 10});
+        CHECK_EQ(from_decimal("0.(3)e1"), Fraction{10, 3});
+    }
+
+    TEST_CASE("Malformed or out of range text")
+    {
+        Fraction frac{1, 2};
+        CHECK_FALSE(parse_decimal("", frac));
+        CHECK_FALSE(parse_decimal("abc", frac));
+        CHECK_FALSE(parse_decimal("1.2.3", frac));
+        CHECK_FALSE(parse_decimal("0.()", frac));
+        CHECK_FALSE(parse_decimal("0.(3", frac));
+        CHECK_FALSE(parse_decimal("1e", frac));
+        CHECK_FALSE(parse_decimal("1e-12", frac));
+        CHECK_FALSE(parse_decimal("99999999999", frac));
+        CHECK_EQ(frac, Fraction{1, 2});
+        CHECK_THROWS_AS(from_decimal("1/2"), std::invalid_argument);
+    }
+}
+
+TEST_SUITE("Batch writer tests")
+{
+    TEST_CASE("Ratio rows as CSV")
+    {
+        std::vector<Fraction> row{Fraction{1, 2}, Fraction{-3, 4}, Fraction{6, -8}, Fraction{5, 1}};
+        FractionWriter writer;
+        writer.append(row);
+        writer.end_row();
+        writer.append(Fraction{0, 7});
+        writer.append(Fraction{2, 3});
+        writer.end_row();
+
+        std::stringstream ss;
+        writer.flush(ss);
+        CHECK(ss.str() == "1/2,-3/4,-3/4,5/1\n0/1,2/3\n");
+        CHECK(writer.view().empty());
+    }
+
+    TEST_CASE("Decimal and mixed formats")
+    {
+        std::vector<Fraction> values{Fraction{1, 3}, Fraction{2, 3}, Fraction{-1, 8}, Fraction{1999, 2000}, Fraction{-1, 3000}};
+        FractionWriter decimal(FractionFormat::DECIMAL, ' ', 3);
+        decimal.append(values);
+        CHECK(decimal.view() == "0.333 0.667 -0.125 1.000 0.000");
+
+        FractionWriter whole(FractionFormat::DECIMAL, ' ', 0);
+        whole.append(values);
+        CHECK(whole.view() == "0 1 0 1 0");
+
+        std::vector<Fraction> mixed_values{Fraction{7, 3}, Fraction{-7, 3}, Fraction{1, 3}, Fraction{4, 2}};
+        FractionWriter mixed(FractionFormat::MIXED, ';');
+        mixed.append(mixed_values);
+        CHECK(mixed.view() == "2 1/3;-2 1/3;1/3;2");
+    }
+}
+
+TEST_SUITE("Decimal expansion tests")
+{
+    static std::string decimal(const Fraction &frac, int digits, RoundingMode mode)
+    {
+        std::vector<char> buf(Fraction::decimal_buffer_size(digits));
+        std::size_t length = frac.to_decimal(buf.data(), digits, mode);
+        return {buf.data(), length};
+    }
+
+    TEST_CASE("Long expansions are exact")
+    {
+        CHECK(decimal(Fraction{1, 7}, 30, RoundingMode::TRUNCATE) == "0.142857142857142857142857142857");
+        CHECK(decimal(Fraction{-22, 7}, 20, RoundingMode::TRUNCATE) == "-3.14285714285714285714");
+        CHECK(decimal(Fraction{2147483647, 1}, 2, RoundingMode::HALF_AWAY) == "2147483647.00");
+        CHECK(decimal(Fraction{-2147483647, 2147483646}, 4, RoundingMode::HALF_AWAY) == "-1.0000");
+    }
+
+    TEST_CASE("Rounding modes")
+    {
+        Fraction pos{5, 8}; // 0.625
+        Fraction neg{-5, 8};
+        CHECK(decimal(pos, 2, RoundingMode::TRUNCATE) == "0.62");
+        CHECK(decimal(pos, 2, RoundingMode::FLOOR) == "0.62");
+        CHECK(decimal(pos, 2, RoundingMode::CEIL) == "0.63");
+        CHECK(decimal(pos, 2, RoundingMode::HALF_AWAY) == "0.63");
+        CHECK(decimal(pos, 2, RoundingMode::HALF_EVEN) == "0.62");
+        CHECK(decimal(neg, 2, RoundingMode::TRUNCATE) == "-0.62");
+        CHECK(decimal(neg, 2, RoundingMode::FLOOR) == "-0.63");
+        CHECK(decimal(neg, 2, RoundingMode::CEIL) == "-0.62");
+        CHECK(decimal(neg, 2, RoundingMode::HALF_AWAY) == "-0.63");
+        CHECK(decimal(Fraction{3, 8}, 2, RoundingMode::HALF_EVEN) == "0.38");
+        CHECK(decimal(Fraction{5, 2}, 0, RoundingMode::HALF_EVEN) == "2");
+        CHECK(decimal(Fraction{999, 1000}, 2, RoundingMode::HALF_AWAY) == "1.00");
+        CHECK(decimal(Fraction{-1, 1000}, 2, RoundingMode::CEIL) == "0.00");
+        CHECK(decimal(Fraction{-1, 1000}, 2, RoundingMode::FLOOR) == "-0.01");
+    }
+
+    TEST_CASE("Terminating versus repeating expansions")
+    {
+        CHECK(Fraction{3, 8}.has_terminating_decimal());
+        CHECK(Fraction{7, 20}.has_terminating_decimal());
+        CHECK(Fraction{5, 1}.has_terminating_decimal());
+        CHECK_FALSE(Fraction{1, 3}.has_terminating_decimal());
+        CHECK_FALSE(Fraction{-1, 14}.has_terminating_decimal());
+    }
+}
+
+TEST_SUITE("Shared-memory ring tests")
+{
+    TEST_CASE("Packed words round-trip")
+    {
+        for (const Fraction &frac : {Fraction{-3, 4}, Fraction{0, 5}, Fraction{2147483647, 2}})
+        {
+            CHECK_EQ(unpack(pack(frac)), frac);
+        }
+    }
+
+    TEST_CASE("Batched publish and consume across threads")
+    {
+        FractionRing ring(8);
+        CHECK_EQ(ring.capacity(), 8);
+
+        const int total = 10000;
+        std::thread producer([&ring]
+                             {
+            std::vector<Fraction> batch;
+            for (int i = 1; i <= total; ++i)
+            {
+                batch.emplace_back(i, i + 1);
+                if (batch.size() == 13 || i == total)
+                {
+                    ring.publish(batch);
+                    batch.clear();
+                }
+            }
+            ring.close(); });
+
+        std::vector<Fraction> out(5);
+        int expected = 1;
+        bool in_order = true;
+        while (std::size_t count = ring.consume(out))
+        {
+            for (std::size_t i = 0; i < count; ++i, ++expected)
+            {
+                in_order = in_order && out[i] == Fraction{expected, expected + 1};
+            }
+        }
+        producer.join();
+        CHECK(in_order);
+        CHECK_EQ(expected, total + 1);
+    }
+
+    TEST_CASE("Named ring is shared between mappings")
+    {
+        const std::string name = "/fraction_ring_test_" + std::to_string(getpid());
+        FractionRing writer = FractionRing::create(name, 5);
+        FractionRing reader = FractionRing::open(name);
+        FractionRing::unlink(name);
+        CHECK_EQ(reader.capacity(), 8);
+
+        std::vector<Fraction> values{Fraction{1, 2}, Fraction{-2, 3}, Fraction{7, 1}};
+        CHECK_EQ(writer.try_publish(values), 3);
+        std::vector<Fraction> out(4);
+        CHECK_EQ(reader.try_consume(out), 3);
+        CHECK_EQ(out[1], Fraction{-2, 3});
+        CHECK_EQ(reader.try_consume(out), 0);
+    }
+
+    TEST_CASE("Opening an empty or truncated segment throws")
+    {
+        const std::string name = "/fraction_ring_bad_" + std::to_string(getpid());
+        // Created but never sized, as seen by open() racing a create()
+        int file = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        REQUIRE(file >= 0);
+        CHECK_THROWS_AS(FractionRing::open(name), std::runtime_error);
+        // Large enough for a header of zeros, which was never marked ready
+        CHECK_EQ(ftruncate(file, 4096), 0);
+        CHECK_THROWS_AS(FractionRing::open(name), std::runtime_error);
+        close(file);
+        FractionRing::unlink(name);
+
+        // A valid ring cut short after creation
+        FractionRing writer = FractionRing::create(name, 1024);
+        file = shm_open(name.c_str(), O_RDWR, 0);
+        REQUIRE(file >= 0);
+        CHECK_EQ(ftruncate(file, 256), 0);
+        close(file);
+        CHECK_THROWS_AS(FractionRing::open(name), std::runtime_error);
+        FractionRing::unlink(name);
+    }
+}
+
+TEST_SUITE("FractionVector tests")
+{
+    TEST_CASE("Elementwise kernels match the scalar operators")
+    {
+        std::vector<Fraction> lhs;
+        std::vector<Fraction> rhs;
+        for (int i = 1; i <= 2100; ++i)
+        {
+            lhs.emplace_back(i % 17 - 8, i % 13 + 1);
+            rhs.emplace_back(i % 11 + 1, -(i % 7 + 1));
+        }
+        FractionVector col_a(lhs);
+        FractionVector col_b(rhs);
+        CHECK_EQ(reinterpret_cast<std::uintptr_t>(col_a.numerators()) % 64, 0);
+
+        FractionVector sums = add(col_a, col_b);
+        FractionVector diffs = sub(col_a, col_b);
+        FractionVector prods = mul(col_a, col_b);
+        FractionVector quots = div(col_a, col_b);
+        std::vector<int8_t> order = compare(col_a, col_b);
+        bool same = true;
+        for (std::size_t i = 0; i < lhs.size(); ++i)
+        {
+            same = same && sums[i] == lhs[i] + rhs[i];
+            same = same && diffs[i] == lhs[i] - rhs[i];
+            same = same && prods[i] == lhs[i] * rhs[i];
+            same = same && quots[i] == lhs[i] / rhs[i];
+            same = same && order[i] == (lhs[i] < rhs[i] ? -1 : (lhs[i] == rhs[i] ? 0 : 1));
+            same = same && quots.denominators()[i] > 0;
+        }
+        CHECK(same);
+    }
+
+    TEST_CASE("Errors and reduction")
+    {
+        FractionVector big(std::vector<Fraction>{Fraction{2147483647, 1}});
+        CHECK_THROWS_AS(add(big, big), std::overflow_error);
+        FractionVector zero(std::vector<Fraction>{Fraction{0, 1}});
+        CHECK_THROWS_AS(div(big, zero), std::runtime_error);
+        CHECK_THROWS_AS(add(big, FractionVector(2)), std::invalid_argument);
+
+        std::vector<Fraction> values{Fraction{1, 2}, Fraction{1, 3}, Fraction{1, 6}, Fraction{-3, 4}};
+        CHECK_EQ(FractionVector(values).sum(), Fraction{1, 4});
+        CHECK_EQ(FractionVector().sum(), Fraction{0, 1});
+    }
+}
+
+TEST_SUITE("Hashing and flat map tests")
+{
+    TEST_CASE("std::hash agrees with equality")
+    {
+        std::hash<Fraction> hasher;
+        CHECK_EQ(hasher(Fraction{2, 4}), hasher(Fraction{1, 2}));
+        CHECK_EQ(hasher(Fraction{3, -6}), hasher(Fraction{-1, 2}));
+        CHECK_EQ(hasher(Fraction{0, 5}), hasher(Fraction{0, -3}));
+        CHECK_NE(hasher(Fraction{1, 2}), hasher(Fraction{2, 1}));
+    }
+
+    TEST_CASE("FractionMap insert, lookup, update and erase")
+    {
+        FractionMap<int> counts;
+        for (int i = 1; i <= 5000; ++i)
+        {
+            counts[Fraction{i % 50, i % 7 + 1}] += 1;
+        }
+        CHECK_EQ(*counts.find(Fraction{2, 4}), counts[Fraction{1, 2}]);
+        CHECK(counts.contains(Fraction{0, 1}));
+        CHECK_EQ(counts.find(Fraction{1, 1000}), nullptr);
+        CHECK_FALSE(counts.insert(Fraction{0, 1}, 99));
+
+        int total = 0;
+        counts.for_each([&total](const Fraction & /*key*/, int value)
+                        { total += value; });
+        CHECK_EQ(total, 5000);
+
+        std::size_t before = counts.size();
+        std::vector<Fraction> keys;
+        counts.for_each([&keys](const Fraction &key, int /*value*/)
+                        { keys.push_back(key); });
+        for (std::size_t i = 0; i < keys.size(); i += 2)
+        {
+            CHECK(counts.erase(keys[i]));
+        }
+        CHECK_FALSE(counts.erase(Fraction{1, 1000}));
+        CHECK_EQ(counts.size(), before - (before + 1) / 2);
+        bool lookups_ok = true;
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            lookups_ok = lookups_ok && counts.contains(keys[i]) == (i % 2 == 1);
+        }
+        CHECK(lookups_ok);
+    }
+
+    TEST_CASE("Updating a present key does not rehash")
+    {
+        // 12 keys fill the 16 initial slots up to the 3/4 load limit
+        FractionMap<int> counts;
+        for (int i = 1; i <= 12; ++i)
+        {
+            counts[Fraction{1, i}] = i;
+        }
+        int *first = counts.find(Fraction{1, 1});
+        counts[Fraction{1, 1}] = 100;
+        CHECK_FALSE(counts.insert(Fraction{1, 2}, 0));
+        CHECK_EQ(counts.find(Fraction{1, 1}), first);
+        CHECK_EQ(*first, 100);
+
+        counts[Fraction{1, 13}] = 13;
+        CHECK_EQ(counts.size(), 13);
+        CHECK_EQ(*counts.find(Fraction{1, 1}), 100);
+    }
+
+    TEST_CASE("FractionSet deduplicates equal values")
+    {
+        FractionSet seen;
+        CHECK(seen.insert(Fraction{1, 3}));
+        CHECK_FALSE(seen.insert(Fraction{2, 6}));
+        CHECK(seen.insert(Fraction{-1, 3}));
+        CHECK_EQ(seen.size(), 2);
+        CHECK(seen.erase(Fraction{1, 3}));
+        CHECK_FALSE(seen.contains(Fraction{1, 3}));
+    }
+}
+
+TEST_SUITE("Interning tests")
+{
+    TEST_CASE("Repeated constructions hit the table")
+    {
+        FractionInternTable table(64);
+        CHECK_EQ(table.capacity(), 64);
+        CHECK_EQ(table.make(6, -8), Fraction{-3, 4});
+        CHECK_EQ(table.make(6, -8), Fraction{-3, 4});
+        CHECK_EQ(table.make(3, 4), Fraction{3, 4});
+        CHECK_EQ(table.hits(), 1);
+        CHECK_EQ(table.misses(), 2);
+        CHECK_EQ(table.hit_rate(), doctest::Approx(1.0 / 3));
+        CHECK_THROWS_AS(table.make(1, 0), std::invalid_argument);
+
+        table.clear();
+        CHECK_EQ(table.hits() + table.misses(), 0);
+        CHECK_EQ(interned(10, 20), Fraction{1, 2});
+        CHECK_EQ(interned(10, 20), Fraction{1, 2});
+        CHECK_GE(thread_intern_table().hits(), 1);
+    }
+}
+
+TEST_SUITE("Operation cache tests")
+{
+    TEST_CASE("Repeated operations are served from the cache")
+    {
+        enable_operation_cache(256, 1000, 0.0);
+        Fraction half{1, 2};
+        Fraction third{1, 3};
+        for (int i = 0; i < 10; ++i)
+        {
+            CHECK_EQ(half + third, Fraction{5, 6});
+            CHECK_EQ(half - third, Fraction{1, 6});
+            CHECK_EQ(half * third, Fraction{1, 6});
+            CHECK_EQ(half / third, Fraction{3, 2});
+        }
+        OperationCache *cache = thread_operation_cache();
+        REQUIRE(cache != nullptr);
+        CHECK_EQ(cache->misses(), 4);
+        CHECK_EQ(cache->hits(), 36);
+        CHECK_THROWS_AS(half / Fraction(0, 1), std::runtime_error);
+        disable_operation_cache();
+        CHECK_EQ(active_operation_cache(), nullptr);
+    }
+
+    TEST_CASE("Low hit rate switches the cache off")
+    {
+        enable_operation_cache(64, 100, 0.5);
+        for (int i = 1; i <= 100; ++i)
+        {
+            Fraction sum = Fraction{i, i + 1} + Fraction{1, i};
+            (void)sum;
+        }
+        CHECK_FALSE(thread_operation_cache()->active());
+        CHECK_EQ(active_operation_cache(), nullptr);
+        disable_operation_cache();
+    }
+}
+
+TEST_SUITE("Sort engine tests")
+{
+    static std::vector<Fraction> sort_input(int count)
+    {
+        std::vector<Fraction> values;
+        unsigned state = 12345;
+        for (int i = 0; i < count; ++i)
+        {
+            state = state * 1103515245U + 12345U;
+            int num = static_cast<int>(state % 2001) - 1000;
+            state = state * 1103515245U + 12345U;
+            values.emplace_back(num, static_cast<int>(state % 997) + 1);
+        }
+        // Values whose doubles collide but that differ exactly
+        values.emplace_back(2147483646, 2147483647);
+        values.emplace_back(2147483645, 2147483646);
+        values.emplace_back(-2147483646, 2147483647);
+        values.emplace_back(-2147483645, 2147483646);
+        values.emplace_back(2147483647, 1);
+        values.emplace_back(-2147483647, 1);
+        return values;
+    }
+
+    TEST_CASE("exact_compare does not overflow")
+    {
+        Fraction big{2147483647, 1};
+        Fraction small{1, 2147483647};
+        CHECK_EQ(exact_compare(big, small), 1);
+        CHECK_EQ(exact_compare(small, big), -1);
+        CHECK_EQ(exact_compare(Fraction{2, 4}, Fraction{1, 2}), 0);
+        CHECK(exact_less(Fraction{2147483645, 2147483646}, Fraction{2147483646, 2147483647}));
+    }
+
+    TEST_CASE("sort and parallel_sort give the exact order")
+    {
+        std::vector<Fraction> expected = sort_input(50000);
+        std::vector<Fraction> serial = expected;
+        std::vector<Fraction> parallel = expected;
+        std::stable_sort(expected.begin(), expected.end(), exact_less);
+
+        ariel::sort(serial);
+        ariel::parallel_sort(parallel, 4);
+        bool serial_ok = true;
+        bool parallel_ok = true;
+        for (std::size_t i = 0; i < expected.size(); ++i)
+        {
+            serial_ok = serial_ok && exact_compare(serial[i], expected[i]) == 0;
+            parallel_ok = parallel_ok && exact_compare(parallel[i], expected[i]) == 0;
+        }
+        CHECK(serial_ok);
+        CHECK(parallel_ok);
+
+        std::vector<Fraction> empty;
+        CHECK_NOTHROW(ariel::sort(empty));
+    }
+}
+
+TEST_SUITE("Ordered index tests")
+{
+    TEST_CASE("Bulk load, lower_bound and range queries")
+    {
+        std::vector<Fraction> keys;
+        std::vector<int> rows;
+        for (int den = 1; den <= 60; ++den)
+        {
+            for (int num = 0; num <= den; ++num)
+            {
+                keys.emplace_back(num, den);
+                rows.push_back(static_cast<int>(rows.size()));
+            }
+        }
+        std::stable_sort(keys.begin(), keys.end(), exact_less);
+        FractionIndex<int> index;
+        index.bulk_load(keys, rows);
+        CHECK_EQ(index.size(), keys.size());
+
+        std::size_t expected = 0;
+        for (const Fraction &key : keys)
+        {
+            expected += static_cast<std::size_t>(!exact_less(key, Fraction{1, 3}) && exact_less(key, Fraction{2, 5}));
+        }
+        std::size_t found = 0;
+        bool in_range = true;
+        index.range(Fraction{1, 3}, Fraction{2, 5}, [&](const Fraction &key, int /*row*/)
+                    {
+            ++found;
+            in_range = in_range && !exact_less(key, Fraction{1, 3}) && exact_less(key, Fraction{2, 5}); });
+        CHECK_EQ(found, expected);
+        CHECK(in_range);
+
+        CHECK_EQ(index.lower_bound(Fraction{1, 3}).key(), Fraction{1, 3});
+        CHECK(index.lower_bound(Fraction{2, 1}) == index.end());
+        CHECK_EQ(index.begin().key(), Fraction{0, 1});
+
+        std::vector<Fraction> unsorted{Fraction{1, 2}, Fraction{1, 3}};
+        std::vector<int> two{0, 1};
+        CHECK_THROWS_AS(index.bulk_load(unsorted, two), std::invalid_argument);
+    }
+
+    TEST_CASE("Inserts keep order and nearest finds the closest key")
+    {
+        FractionIndex<int> index;
+        CHECK(index.nearest(Fraction{1, 2}) == index.end());
+        std::vector<Fraction> inserted;
+        unsigned state = 7;
+        for (int i = 0; i < 20000; ++i)
+        {
+            state = state * 1103515245U + 12345U;
+            Fraction key(static_cast<int>(state % 1000) - 500, static_cast<int>((state >> 12U) % 97) + 1);
+            index.insert(key, i);
+            inserted.push_back(key);
+        }
+        CHECK_EQ(index.size(), inserted.size());
+
+        std::stable_sort(inserted.begin(), inserted.end(), exact_less);
+        bool ordered = true;
+        std::size_t pos = 0;
+        for (auto it = index.begin(); it != index.end(); ++it, ++pos)
+        {
+            ordered = ordered && exact_compare(it.key(), inserted[pos]) == 0;
+        }
+        CHECK(ordered);
+        CHECK_EQ(pos, inserted.size());
+
+        FractionIndex<int> small;
+        small.insert(Fraction{1, 4}, 1);
+        small.insert(Fraction{1, 2}, 2);
+        small.insert(Fraction{3, 4}, 3);
+        CHECK_EQ(small.nearest(Fraction{2, 5}).value(), 2);
+        CHECK_EQ(small.nearest(Fraction{3, 8}).value(), 1);
+        CHECK_EQ(small.nearest(Fraction{-7, 1}).value(), 1);
+        CHECK_EQ(small.nearest(Fraction{7, 1}).value(), 3);
+    }
+}
+
+TEST_SUITE("Streaming statistics tests")
+{
+    TEST_CASE("Exact sum, mean, variance and extremes")
+    {
+        FractionAccumulator acc;
+        CHECK_THROWS_AS(acc.mean(), std::runtime_error);
+        std::vector<Fraction> values{Fraction{1, 2}, Fraction{1, 3}, Fraction{-1, 6}, Fraction{5, 4}};
+        acc.add(values);
+        CHECK_EQ(acc.count(), 4);
+        CHECK_EQ(acc.sum(), Fraction{23, 12});
+        CHECK_EQ(acc.mean(), Fraction{23, 48});
+        // squares: 1/4 + 1/9 + 1/36 + 25/16 = 281/144
+        CHECK_EQ(acc.sum_of_squares(), Fraction{281, 144});
+        // 281/576 - (23/48)^2
+        CHECK_EQ(acc.variance(), Fraction{281 * 4 - 23 * 23, 2304});
+        CHECK_EQ(acc.min(), Fraction{-1, 6});
+        CHECK_EQ(acc.max(), Fraction{5, 4});
+        CHECK_FALSE(acc.is_wide());
+    }
+
+    TEST_CASE("Promotion to 128 bits and merging partial results")
+    {
+        // Denominators with many distinct prime factors push the lcm past 64 bits
+        std::vector<Fraction> values;
+        for (int prime : {1009, 1013, 1019, 1021, 1031, 1033, 1039})
+        {
+            values.emplace_back(1, prime);
+            values.emplace_back(-1, prime);
+        }
+        FractionAccumulator whole;
+        whole.add(values);
+        CHECK(whole.is_wide());
+        CHECK_EQ(whole.sum(), Fraction{0, 1});
+        CHECK_EQ(whole.mean(), Fraction{0, 1});
+
+        FractionAccumulator left;
+        FractionAccumulator right;
+        left.add(std::span<const Fraction>(values).first(7));
+        right.add(std::span<const Fraction>(values).subspan(7));
+        left.merge(right);
+        CHECK_EQ(left.count(), whole.count());
+        CHECK_EQ(left.sum(), whole.sum());
+        CHECK_EQ(left.min(), whole.min());
+        CHECK_EQ(left.max(), Fraction{1, 1009});
+
+        FractionAccumulator small_a;
+        FractionAccumulator small_b;
+        small_a.add(Fraction{1, 4});
+        small_b.add(Fraction{1, 6});
+        small_a.merge(small_b);
+        CHECK_FALSE(small_a.is_wide());
+        CHECK_EQ(small_a.sum(), Fraction{5, 12});
+    }
+}
+
+TEST_SUITE("Fixed-denominator tests")
+{
+    TEST_CASE("Exact conversions and integer arithmetic")
+    {
+        using Cents = FixedDenomFraction<100>;
+        static_assert(sizeof(Cents) == 4);
+        Cents price(Fraction{5, 4});
+        CHECK_EQ(price.raw(), 125);
+        Cents tax(Fraction{-3, 20});
+        CHECK_EQ((price + tax).to_fraction(), Fraction{11, 10});
+        CHECK_EQ((price - tax).to_fraction(), Fraction{7, 5});
+        CHECK_EQ((price * 3).raw(), 375);
+        CHECK_EQ((-tax).raw(), 15);
+        CHECK(tax < price);
+        CHECK_EQ(Cents::from_raw(50), Cents(Fraction{1, 2}));
+
+        CHECK_THROWS_AS(Cents(Fraction{1, 3}), std::invalid_argument);
+        CHECK_THROWS_AS(Cents::from_raw(2147483647) + Cents::from_raw(1), std::overflow_error);
+
+        FixedDenomFraction<90000> ticks(Fraction{1, 30});
+        CHECK_EQ(ticks.raw(), 3000);
+        FixedDenomFraction<1000> millis(Fraction(0.333F));
+        CHECK_EQ(millis.raw(), 333);
+
+        std::stringstream ss;
+        ss << Cents::from_raw(-250);
+        CHECK(ss.str() == "-5/2");
+    }
+}
+
+TEST_SUITE("Dyadic fraction tests")
+{
+    TEST_CASE("Normalization and exact conversions")
+    {
+        DyadicFraction three_quarters(Fraction{3, 4});
+        CHECK_EQ(three_quarters.mantissa(), 3);
+        CHECK_EQ(three_quarters.exponent(), -2);
+        CHECK_EQ(DyadicFraction(12, 0), DyadicFraction(3, 2));
+        CHECK_EQ(DyadicFraction(Fraction{-40, 1}).to_fraction(), Fraction{-40, 1});
+        CHECK_EQ(DyadicFraction(Fraction{0, 7}), DyadicFraction());
+        CHECK_THROWS_AS(DyadicFraction(Fraction{1, 3}), std::invalid_argument);
+
+        CHECK_EQ(DyadicFraction::from_double(0.375).to_fraction(), Fraction{3, 8});
+        CHECK_EQ(DyadicFraction::from_double(-1.5e3).to_fraction(), Fraction{-1500, 1});
+        CHECK_EQ(DyadicFraction::from_double(0.1).to_double(), 0.1);
+        CHECK_THROWS_AS(DyadicFraction::from_double(0.1).to_fraction(), std::overflow_error);
+        CHECK_THROWS_AS(DyadicFraction::from_double(1.0 / 0.0), std::invalid_argument);
+    }
+
+    TEST_CASE("Shift-based arithmetic and ordering")
+    {
+        DyadicFraction half(Fraction{1, 2});
+        DyadicFraction eighth(Fraction{1, 8});
+        CHECK_EQ((half + eighth).to_fraction(), Fraction{5, 8});
+        CHECK_EQ((eighth - half).to_fraction(), Fraction{-3, 8});
+        CHECK_EQ((half * eighth).to_fraction(), Fraction{1, 16});
+        CHECK_EQ((half - half), DyadicFraction());
+        CHECK_EQ((half + half).to_fraction(), Fraction{1, 1});
+        CHECK_EQ((-half).to_fraction(), Fraction{-1, 2});
+
+        CHECK(eighth < half);
+        CHECK(-half < eighth);
+        CHECK(-half < -eighth);
+        CHECK(DyadicFraction(3, 0) > DyadicFraction(5, -1));
+        CHECK(DyadicFraction(5, -1) > DyadicFraction(1, 1));
+        CHECK_THROWS_AS(DyadicFraction(1, 62) + DyadicFraction(1, -10), std::overflow_error);
+        // Exponent gaps beyond the int range
+        CHECK_THROWS_AS(DyadicFraction(1, INT_MAX) + DyadicFraction(1, INT_MIN), std::overflow_error);
+        CHECK_THROWS_AS(DyadicFraction(3, INT_MIN) - DyadicFraction(1, INT_MAX), std::overflow_error);
+        CHECK_EQ(DyadicFraction(1, INT_MIN) + DyadicFraction(1, INT_MIN), DyadicFraction(1, INT_MIN + 1));
+    }
+}
+
+TEST_SUITE("Compact storage tests")
+{
+    TEST_CASE("Checked narrowing and widening")
+    {
+        static_assert(sizeof(Fraction16) == 4);
+        CHECK_EQ(Fraction16(Fraction{-32768, 65535}).widen(), Fraction{-32768, 65535});
+        CHECK_EQ(Fraction16(Fraction{32767, 1}).widen(), Fraction{32767, 1});
+        CHECK_EQ(Fraction16().widen(), Fraction{0, 1});
+        CHECK_THROWS_AS(Fraction16(Fraction{32768, 1}), std::overflow_error);
+        CHECK_THROWS_AS(Fraction16(Fraction{1, 65536}), std::overflow_error);
+        Fraction16 out;
+        CHECK_FALSE(Fraction16::try_narrow(Fraction{-32769, 2}, out));
+        CHECK_FALSE(Fraction16::fits(Fraction(INT_MAX, 1)));
+        CHECK_FALSE(Fraction16::fits(Fraction(-INT_MAX, 1)));
+        CHECK_FALSE(Fraction16::fits(Fraction(1, INT_MAX)));
+    }
+
+    TEST_CASE("Batch pack and unpack")
+    {
+        std::vector<Fraction> values{Fraction{1, 2}, Fraction{-7, 9}, Fraction{300, 301}};
+        std::vector<Fraction16> packed(values.size());
+        CHECK_EQ(pack16(values, packed), values.size());
+        std::vector<Fraction> widened(values.size());
+        unpack16(packed, widened);
+        CHECK(widened == values);
+
+        values.insert(values.begin() + 1, Fraction{1, 100000});
+        packed.resize(values.size());
+        CHECK_EQ(pack16(values, packed), 1);
+    }
+}
+
+TEST_SUITE("Parallel sum tests")
+{
+    TEST_CASE("Pairwise sum is exact and independent of the thread count")
+    {
+        // 1/(k(k+1)) telescopes to 1 - 1/(n+1); a left fold overflows long before the end
+        std::vector<Fraction> values;
+        const int count = 20000;
+        for (int k = 1; k <= count; ++k)
+        {
+            values.emplace_back(1, k * (k + 1));
+        }
+        Fraction expected{count, count + 1};
+        CHECK_EQ(parallel_sum(values, 1), expected);
+        CHECK_EQ(parallel_sum(values, 3), expected);
+        CHECK_EQ(parallel_sum(values, 8), expected);
+
+        std::vector<Fraction> none;
+        CHECK_EQ(parallel_sum(none), Fraction{0, 1});
+
+        std::vector<Fraction> big{Fraction{2147483647, 1}, Fraction{1, 1}};
+        CHECK_THROWS_AS(parallel_sum(big, 2), std::overflow_error);
+    }
+}
+
+TEST_SUITE("Atomic fraction tests")
+{
+    TEST_CASE("Single-thread operations")
+    {
+        AtomicFraction value(Fraction{1, 2});
+        Fraction previous;
+        CHECK(value.fetch_add(Fraction{1, 3}, previous));
+        CHECK_EQ(previous, Fraction{1, 2});
+        CHECK_EQ(value.load(), Fraction{5, 6});
+        CHECK(value.fetch_mul(Fraction{-6, 5}));
+        CHECK_EQ(value.load(), Fraction{-1, 1});
+
+        Fraction expected{1, 2};
+        CHECK_FALSE(value.compare_exchange(expected, Fraction{7, 1}));
+        CHECK_EQ(expected, Fraction{-1, 1});
+        CHECK(value.compare_exchange(expected, Fraction{7, 1}));
+        CHECK_EQ(value.exchange(Fraction{2147483647, 1}), Fraction{7, 1});
+
+        CHECK_FALSE(value.fetch_add(Fraction{1, 1}, previous));
+        CHECK_EQ(previous, Fraction{2147483647, 1});
+        CHECK_FALSE(value.fetch_mul(Fraction{2, 1}));
+        CHECK_EQ(value.load(), Fraction{2147483647, 1});
+    }
+
+    TEST_CASE("Concurrent fetch_add loses no updates")
+    {
+        AtomicFraction total;
+        std::vector<std::thread> workers;
+        for (int thread = 0; thread < 4; ++thread)
+        {
+            workers.emplace_back([&total]
+                                 {
+                for (int i = 0; i < 5000; ++i)
+                {
+                    total.fetch_add(Fraction{1, 4});
+                } });
+        }
+        for (std::thread &worker : workers)
+        {
+            worker.join();
+        }
+        CHECK_EQ(total.load(), Fraction{5000, 1});
+    }
+}
+
+TEST_SUITE("Sharded accumulator tests")
+{
+    TEST_CASE("Concurrent local updates merge exactly")
+    {
+        ShardedAccumulator total(8);
+        CHECK_EQ(total.shard_count(), 8);
+        CHECK_EQ(total.read(), Fraction{0, 1});
+
+        // 12 threads against 8 shards also exercises the spill shard
+        std::vector<std::thread> workers;
+        for (int thread = 0; thread < 12; ++thread)
+        {
+            workers.emplace_back([&total, thread]
+                                 {
+                for (int i = 0; i < 3000; ++i)
+                {
+                    total.add(Fraction{1, 2 + thread % 5});
+                } });
+        }
+        Fraction early = total.read();
+        CHECK(early >= Fraction{0, 1});
+        for (std::thread &worker : workers)
+        {
+            worker.join();
+        }
+        // Each thread contributed 3000 * 1/(2 + thread % 5)
+        Fraction expected;
+        for (int thread = 0; thread < 12; ++thread)
+        {
+            expected = expected + Fraction{3000, 2 + thread % 5};
+        }
+        CHECK_EQ(total.read(), expected);
+    }
+
+    TEST_CASE("Exited threads give their shard back")
+    {
+        // Far more short-lived threads than shards, one after another: each must still
+        // land on a real shard instead of the spill shard
+        ShardedAccumulator total(4);
+        for (int thread = 0; thread < 40; ++thread)
+        {
+            std::thread worker([&total]
+                               { total.add(Fraction{1, 4}); });
+            worker.join();
+        }
+        CHECK_EQ(total.spilled(), 0);
+        CHECK_EQ(total.read(), Fraction{10, 1});
+    }
+}
+
+TEST_SUITE("Work-stealing executor tests")
+{
+    TEST_CASE("Every task runs exactly once")
+    {
+        FractionExecutor executor(4);
+        CHECK_EQ(executor.thread_count(), 4);
+        std::vector<int> hits(1000, 0);
+        executor.run(hits.size(), [&](std::size_t i)
+                     { ++hits[i]; });
+        CHECK(std::all_of(hits.begin(), hits.end(), [](int hit)
+                          { return hit == 1; }));
+        executor.run(0, [](std::size_t) {});
+
+        ExecutorStats stats = executor.stats();
+        CHECK_EQ(stats.batches, 1);
+        CHECK_EQ(stats.tasks, 1000);
+        CHECK_EQ(stats.workers.size(), 4);
+        CHECK(stats.steals <= stats.tasks);
+    }
+
+    TEST_CASE("Chunks cover the data and report throughput")
+    {
+        FractionExecutor executor(3);
+        std::vector<Fraction> data;
+        for (int i = 1; i <= 250; ++i)
+        {
+            data.emplace_back(i, i + 1);
+        }
+        executor.for_each_chunk(std::span<Fraction>(data), 16, [](std::span<Fraction> chunk)
+                                {
+            CHECK(chunk.size() <= 16);
+            for (Fraction &value : chunk)
+            {
+                value = value * Fraction{2, 1};
+            } });
+        CHECK_EQ(data[0], Fraction{1, 1});
+        CHECK_EQ(data[249], Fraction{500, 251});
+
+        std::atomic<std::size_t> seen{0};
+        executor.for_each_chunk(std::span<const Fraction>(data), 100, [&](std::span<const Fraction> chunk)
+                                { seen += chunk.size(); });
+        CHECK_EQ(seen.load(), 250);
+
+        ExecutorStats stats = executor.stats();
+        CHECK_EQ(stats.batches, 2);
+        CHECK_EQ(stats.items, 500);
+        CHECK_EQ(stats.tasks, 16 + 3);
+        CHECK(stats.items_per_second() > 0);
+        executor.reset_stats();
+        CHECK_EQ(executor.stats().tasks, 0);
+    }
+
+    TEST_CASE("The lowest failing task's exception is rethrown")
+    {
+        FractionExecutor executor(2);
+        CHECK_THROWS_AS(executor.run(64, [](std::size_t i)
+                                     {
+            if (i >= 40)
+            {
+                throw std::overflow_error(std::to_string(i));
+            } }),
+                        std::overflow_error);
+        try
+        {
+            executor.run(64, [](std::size_t i)
+                         {
+                if (i % 10 == 7)
+                {
+                    throw std::overflow_error(std::to_string(i));
+                } });
+        }
+        catch (const std::overflow_error &error)
+        {
+            CHECK_EQ(std::string(error.what()), "7");
+        }
+        // The pool is still usable after a failed batch
+        std::atomic<int> count{0};
+        executor.run(10, [&](std::size_t)
+                     { ++count; });
+        CHECK_EQ(count.load(), 10);
+    }
+}
+
+TEST_SUITE("Noexcept sticky arithmetic tests")
+{
+    TEST_CASE("Layout guarantees")
+    {
+        CHECK(std::is_trivially_copyable_v<Fraction>);
+        CHECK(std::is_standard_layout_v<Fraction>);
+        CHECK(std::is_nothrow_copy_constructible_v<StickyFraction>);
+        CHECK(noexcept(StickyFraction() + StickyFraction()));
+        CHECK(noexcept(StickyFraction() / StickyFraction()));
+    }
+
+    TEST_CASE("Arithmetic matches the throwing operators")
+    {
+        StickyFraction half(Fraction{1, 2});
+        StickyFraction third(Fraction{1, 3});
+        CHECK_EQ((half + third).value(), Fraction{5, 6});
+        CHECK_EQ((half - third).value(), Fraction{1, 6});
+        CHECK_EQ((half * third).value(), Fraction{1, 6});
+        CHECK_EQ((half / third).value(), Fraction{3, 2});
+        CHECK_EQ(StickyFraction::make(4, -6).value(), Fraction{-2, 3});
+        Fraction out;
+        CHECK((half += third).get(out));
+        CHECK_EQ(out, Fraction{5, 6});
+    }
+
+    TEST_CASE("Errors are sticky and never throw until value()")
+    {
+        StickyFraction big(Fraction{INT32_MAX, 1});
+        StickyFraction zero;
+        StickyFraction overflowed = big * big;
+        CHECK_FALSE(overflowed.ok());
+        CHECK_EQ(overflowed.status(), FractionStatus::OVERFLOWED);
+
+        // Later operations keep the flag, even ones that would succeed on their own
+        StickyFraction later = (overflowed - big) * zero + StickyFraction(Fraction{1, 2});
+        CHECK_EQ(later.status(), FractionStatus::OVERFLOWED);
+        StickyFraction both = later / zero;
+        CHECK((both.status() & FractionStatus::OVERFLOWED));
+        CHECK((both.status() & FractionStatus::DIVIDED_BY_ZERO));
+
+        Fraction out{7, 8};
+        CHECK_FALSE(both.get(out));
+        CHECK_EQ(out, Fraction{7, 8});
+        CHECK_THROWS_AS(overflowed.value(), std::overflow_error);
+        CHECK_THROWS_AS((StickyFraction(Fraction{1, 2}) / zero).value(), std::runtime_error);
+    }
+
+    TEST_CASE("Standard parallel algorithms over Fraction spans")
+    {
+        std::vector<Fraction> values;
+        for (int i = 1; i <= 2000; ++i)
+        {
+            values.emplace_back(1, 1 + i % 8);
+        }
+        std::span<const Fraction> view(values);
+        StickyFraction total = std::transform_reduce(std::execution::par_unseq, view.begin(), view.end(), StickyFraction(),
+                                                     std::plus<>(), [](const Fraction &value) noexcept
+                                                     { return StickyFraction(value); });
+        CHECK(total.ok());
+        CHECK_EQ(total.value(), std::accumulate(values.begin(), values.end(), Fraction()));
+
+        std::vector<StickyFraction> products(values.size());
+        std::transform(std::execution::par_unseq, values.begin(), values.end(), products.begin(), [](const Fraction &value) noexcept
+                       { return StickyFraction(value) * StickyFraction(Fraction{INT32_MAX, 1}); });
+        CHECK(std::all_of(products.begin(), products.end(), [](const StickyFraction &value)
+                          { return value.ok(); }));
+
+        values[1234] = Fraction{INT32_MAX, 1};
+        StickyFraction overflowed = std::transform_reduce(std::execution::par_unseq, values.begin(), values.end(), StickyFraction(),
+                                                          std::plus<>(), [](const Fraction &value) noexcept
+                                                          { return StickyFraction(value); });
+        CHECK_EQ(overflowed.status(), FractionStatus::OVERFLOWED);
+    }
+}
+
+TEST_SUITE("Batch status bitmap tests")
+{
+    TEST_CASE("Bitmap bookkeeping")
+    {
+        StatusBitmap status(70);
+        CHECK_EQ(status.size(), 70);
+        CHECK_EQ(status.words().size(), 3);
+        CHECK(status.all_ok());
+        CHECK_EQ(status.first_error(), 70);
+        status.set(33, FractionStatus::OVERFLOWED);
+        status.set(69, FractionStatus::DIVIDED_BY_ZERO);
+        status.set(5, FractionStatus::OVERFLOWED | FractionStatus::DIVIDED_BY_ZERO);
+        CHECK_EQ(status[33], FractionStatus::OVERFLOWED);
+        CHECK_EQ(status[69], FractionStatus::DIVIDED_BY_ZERO);
+        CHECK_EQ(status[34], FractionStatus::OK);
+        CHECK_EQ(status.first_error(), 5);
+        CHECK_EQ(status.count_of(FractionStatus::OVERFLOWED), 2);
+        CHECK_EQ(status.count_of(FractionStatus::DIVIDED_BY_ZERO), 2);
+        status.set(5, FractionStatus::OK);
+        CHECK_EQ(status.first_error(), 33);
+        status.resize(10);
+        CHECK(status.all_ok());
+    }
+
+    TEST_CASE("One bad element does not abort the batch")
+    {
+        std::vector<Fraction> lhs;
+        std::vector<Fraction> rhs;
+        for (int i = 1; i <= 100; ++i)
+        {
+            lhs.emplace_back(i, 3);
+            rhs.emplace_back(1, i + 1);
+        }
+        lhs[40] = Fraction{INT32_MAX, 1};
+        rhs[40] = Fraction{INT32_MAX, 1};
+        rhs[77] = Fraction{0, 1};
+        std::vector<Fraction> out(lhs.size());
+        StatusBitmap status;
+
+        CHECK_EQ(mul(lhs, rhs, out, status), 1);
+        CHECK_EQ(status[40], FractionStatus::OVERFLOWED);
+        CHECK_EQ(out[40], Fraction{0, 1});
+        CHECK_EQ(out[41], lhs[41] * rhs[41]);
+
+        CHECK_EQ(div(lhs, rhs, out, status), 1);
+        CHECK_EQ(status.first_error(), 77);
+        CHECK_EQ(status[77], FractionStatus::DIVIDED_BY_ZERO);
+        CHECK_EQ(status[40], FractionStatus::OK);
+        CHECK_EQ(out[40], Fraction{1, 1});
+
+        CHECK_EQ(add(lhs, rhs, out, status), 1);
+        CHECK_EQ(sub(lhs, rhs, out, status), 0);
+        for (std::size_t i = 0; i < lhs.size(); ++i)
+        {
+            CHECK_EQ(out[i], lhs[i] - rhs[i]);
+        }
+
+        // In place
+        CHECK_EQ(add(lhs, rhs, lhs, status), 1);
+        CHECK_EQ(lhs[0], Fraction{5, 6});
+
+        std::vector<Fraction> shorter(3);
+        CHECK_THROWS_AS(add(shorter, rhs, out, status), std::invalid_argument);
+    }
+}
+
+TEST_SUITE("Coroutine pipeline tests")
+{
+    TEST_CASE("Records flow through parse, compute and format in order")
+    {
+        std::ostringstream input;
+        std::ostringstream expected;
+        for (int i = 1; i <= 500; ++i)
+        {
+            input << i << " " << i + 1 << "\n";
+            expected << Fraction{2 * i, i + 1} << "\n";
+            if (i % 100 == 0)
+            {
+                input << "bad line\n";
+            }
+        }
+        std::istringstream in(input.str());
+        std::ostringstream out;
+        PipelineOptions options;
+        // Tiny batches and queues force the stages to suspend on each other
+        options.batch_size = 7;
+        options.queue_depth = 1;
+        PipelineStats stats = run_pipeline(in, out, [](std::span<Fraction> batch)
+                                           {
+            for (Fraction &value : batch)
+            {
+                value = value * Fraction{2, 1};
+            } },
+                                           options);
+        CHECK_EQ(out.str(), expected.str());
+        CHECK_EQ(stats.parse_errors, 5);
+        CHECK_EQ(stats.parse.records, 500);
+        CHECK_EQ(stats.compute.records, 500);
+        CHECK_EQ(stats.format.records, 500);
+        CHECK_EQ(stats.format.batches, (500 + 6) / 7);
+        CHECK(stats.parse.busy_seconds >= 0);
+        CHECK(stats.format.blocked_seconds >= 0);
+    }
+
+    TEST_CASE("Decimal output and empty input")
+    {
+        std::istringstream in("1 4\n-1 3\n");
+        std::ostringstream out;
+        PipelineOptions options;
+        options.format = FractionFormat::DECIMAL;
+        options.digits = 2;
+        run_pipeline(in, out, [](std::span<Fraction>) {}, options);
+        CHECK_EQ(out.str(), "0.25\n-0.33\n");
+
+        std::istringstream wide("1 -2147483648\n1 2\n");
+        std::ostringstream half;
+        PipelineStats skipped = run_pipeline(wide, half, [](std::span<Fraction>) {});
+        CHECK_EQ(half.str(), "1/2\n");
+        CHECK_EQ(skipped.parse_errors, 1);
+
+        std::istringstream empty("");
+        std::ostringstream nothing;
+        PipelineStats stats = run_pipeline(empty, nothing, [](std::span<Fraction>) {});
+        CHECK_EQ(nothing.str(), "");
+        CHECK_EQ(stats.format.batches, 0);
+    }
+
+    TEST_CASE("A failing stage cancels the pipeline and rethrows")
+    {
+        std::ostringstream input;
+        for (int i = 0; i < 5000; ++i)
+        {
+            input << "1 2\n";
+        }
+        std::istringstream in(input.str());
+        std::ostringstream out;
+        PipelineOptions options;
+        options.batch_size = 10;
+        options.queue_depth = 2;
+        int batches = 0;
+        CHECK_THROWS_AS(run_pipeline(in, out, [&](std::span<Fraction>)
+                                     {
+            if (++batches == 3)
+            {
+                throw std::overflow_error("compute failed");
+            } },
+                                     options),
+                        std::overflow_error);
+        CHECK_EQ(batches, 3);
+    }
+}
+
+TEST_SUITE("Parallel scan tests")
+{
+    TEST_CASE("Scans match a serial running total for any thread count")
+    {
+        std::vector<Fraction> values;
+        for (int i = 0; i < 10000; ++i)
+        {
+            values.emplace_back((i % 7) - 3, 1 << (i % 4));
+        }
+        std::vector<Fraction> expected(values.size());
+        Fraction running;
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            running = running + values[i];
+            expected[i] = running;
+        }
+        for (unsigned threads : {1U, 3U, 8U})
+        {
+            std::vector<Fraction> out(values.size());
+            StatusBitmap status;
+            CHECK_EQ(parallel_inclusive_scan(values, out, status, threads), 0);
+            CHECK(status.all_ok());
+            CHECK(out == expected);
+
+            CHECK_EQ(parallel_exclusive_scan(values, out, status, threads), 0);
+            CHECK_EQ(out[0], Fraction{0, 1});
+            CHECK(std::equal(out.begin() + 1, out.end(), expected.begin()));
+        }
+
+        // In place
+        StatusBitmap status;
+        parallel_inclusive_scan(values, values, status);
+        CHECK(values == expected);
+
+        std::vector<Fraction> empty;
+        CHECK_EQ(parallel_inclusive_scan(empty, empty, status), 0);
+        CHECK_EQ(status.size(), 0);
+        std::vector<Fraction> shorter(3);
+        CHECK_THROWS_AS(parallel_inclusive_scan(expected, shorter, status), std::invalid_argument);
+    }
+
+    TEST_CASE("Overflow is reported per element")
+    {
+        // The running total leaves int range and comes back
+        std::vector<Fraction> values{Fraction{INT32_MAX, 1}, Fraction{1, 1}, Fraction{-1, 1}, Fraction{-INT32_MAX, 1}};
+        std::vector<Fraction> out(values.size());
+        StatusBitmap status;
+        CHECK_EQ(parallel_inclusive_scan(values, out, status), 1);
+        CHECK_EQ(status[1], FractionStatus::OVERFLOWED);
+        CHECK_EQ(out[1], Fraction{0, 1});
+        CHECK_EQ(out[2], Fraction{INT32_MAX, 1});
+        CHECK_EQ(out[3], Fraction{0, 1});
+        CHECK_EQ(status[3], FractionStatus::OK);
+
+        CHECK_EQ(parallel_exclusive_scan(values, out, status), 1);
+        CHECK_EQ(status[2], FractionStatus::OVERFLOWED);
+        CHECK_EQ(out[3], Fraction{INT32_MAX, 1});
+    }
+
+    TEST_CASE("A 64-bit overflow poisons the rest of the scan")
+    {
+        // Distinct prime denominators: the common denominator outgrows int64 quickly
+        const int primes[] = {1000003, 1000033, 1000037, 1000039};
+        std::vector<Fraction> values(9000, Fraction{0, 1});
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            values[5000 + i] = Fraction{1, primes[i]};
+        }
+        values[8000] = Fraction{1, 1};
+        std::vector<Fraction> out(values.size());
+        StatusBitmap status;
+        std::size_t failed = parallel_inclusive_scan(values, out, status, 4);
+        CHECK_EQ(status.first_error(), 5001);
+        CHECK_EQ(failed, 9000 - 5001);
+        CHECK_EQ(out[5000], Fraction{1, primes[0]});
+        CHECK_EQ(status[8999], FractionStatus::OVERFLOWED);
+    }
+
+    TEST_CASE("Failed elements do not depend on block boundaries")
+    {
+        const int primes[] = {1000003, 1000033, 1000037, 1000039};
+        const std::size_t block = PARALLEL_BLOCK;
+        std::vector<Fraction> values(5 * block, Fraction{0, 1});
+        // Block 1's own total overflows while the running total does not: -1/p0 - 1/p1
+        // carried in, then +1/p0 + 1/p1 + 1/p2 + 1/p3 - 1/p3. Block 2 stays at 1/p2.
+        values[block - 2] = Fraction{-1, primes[0]};
+        values[block - 1] = Fraction{-1, primes[1]};
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            values[block + i] = Fraction{1, primes[i]};
+        }
+        values[block + 4] = Fraction{-1, primes[3]};
+
+        // Block 3's own total stays small, but the running total overflows 64 bits at
+        // 3 * block + 1, so everything from there on fails even though block 4's offset is valid
+        values[3 * block] = Fraction{1, 1000000007};
+        values[3 * block + 1] = Fraction{1, primes[0]};
+        values[3 * block + 2] = Fraction{-1, primes[0]};
+        values[3 * block + 3] = Fraction{-1, 1000000007};
+
+        std::vector<Fraction> out(values.size());
+        StatusBitmap single;
+        StatusBitmap many;
+        std::size_t failed = parallel_inclusive_scan(values, out, single, 1);
+        CHECK_EQ(parallel_inclusive_scan(values, out, many, 4), failed);
+        CHECK(std::equal(single.words().begin(), single.words().end(), many.words().begin(), many.words().end()));
+
+        // Only totals with a denominator beyond int fail before the 64-bit overflow
+        CHECK_EQ(single.first_error(), block - 1);
+        CHECK_EQ(single[block], FractionStatus::OK);
+        CHECK_EQ(single[block + 3], FractionStatus::OVERFLOWED);
+        CHECK_EQ(single[2 * block + 5], FractionStatus::OK);
+        CHECK_EQ(out[2 * block + 5], Fraction{1, primes[2]});
+        CHECK_EQ(single[3 * block + 1], FractionStatus::OVERFLOWED);
+        CHECK_EQ(single[5 * block - 1], FractionStatus::OVERFLOWED);
+        // block - 1, block + 3, then blocks 3 and 4 (3 * block is 1/p2 + 1/1000000007)
+        CHECK_EQ(failed, 2 + 2 * block);
+
+        CHECK_EQ(parallel_exclusive_scan(values, out, single, 1), parallel_exclusive_scan(values, out, many, 4));
+        CHECK(std::equal(single.words().begin(), single.words().end(), many.words().begin(), many.words().end()));
+        CHECK_EQ(single[2 * block + 5], FractionStatus::OK);
+        CHECK_EQ(single[3 * block + 1], FractionStatus::OVERFLOWED);
+        CHECK_EQ(single[3 * block + 2], FractionStatus::OVERFLOWED);
+        CHECK_EQ(single[5 * block - 1], FractionStatus::OVERFLOWED);
+    }
+}
+
+TEST_SUITE("Reciprocal table tests")
+{
+    TEST_CASE("Multiply-shift division is exact")
+    {
+        CHECK_EQ(reciprocal_bound(), DEFAULT_RECIPROCAL_BOUND);
+        const uint32_t samples[] = {0, 1, 2, 999, 1000, 1001, 65535, 123456789, 2147483647U, 2147483648U, UINT32_MAX - 1, UINT32_MAX};
+        int mismatches = 0;
+        for (uint32_t divisor = 1; divisor <= DEFAULT_RECIPROCAL_BOUND + 5; ++divisor)
+        {
+            for (uint32_t num : samples)
+            {
+                mismatches += divide_small(num, divisor) != num / divisor ? 1 : 0;
+            }
+            mismatches += divide_small(divisor * 7 - 1, divisor) != 6 ? 1 : 0;
+        }
+        CHECK_EQ(mismatches, 0);
+    }
+
+    TEST_CASE("Reduced terms must fit in int")
+    {
+        CHECK_THROWS_AS(Fraction(1, INT_MIN), std::overflow_error);
+        CHECK_THROWS_AS(Fraction(INT_MIN, -1), std::overflow_error);
+        CHECK_EQ(Fraction(INT_MIN, 1).getNumerator(), INT_MIN);
+        CHECK_EQ(Fraction(2, INT_MIN), Fraction(-1, 1073741824));
+        CHECK_EQ(Fraction(INT_MIN, INT_MIN), Fraction(1, 1));
+    }
+
+    TEST_CASE("Bounds are per thread and do not change results")
+    {
+        std::vector<Fraction> with_table;
+        for (int i = 1; i < 3000; ++i)
+        {
+            with_table.emplace_back(-i * 6, (i % 97 + 1) * 4);
+        }
+
+        set_reciprocal_bound(0);
+        CHECK_EQ(reciprocal_bound(), 0);
+        uint32_t other_bound = 0;
+        std::thread([&other_bound]
+                    { other_bound = reciprocal_bound(); })
+            .join();
+        CHECK_EQ(other_bound, DEFAULT_RECIPROCAL_BOUND);
+        std::vector<Fraction> without_table;
+        for (int i = 1; i < 3000; ++i)
+        {
+            without_table.emplace_back(-i * 6, (i % 97 + 1) * 4);
+        }
+        CHECK(without_table == with_table);
+        CHECK_EQ(with_table[9], Fraction(-60, 44));
+
+        set_reciprocal_bound(50000);
+        CHECK_EQ(reciprocal_bound(), 50000);
+        CHECK_EQ(divide_small(4000000000U, 49999), 4000000000U / 49999);
+        CHECK_EQ(Fraction(30000 * 7, 30000 * 11), Fraction(7, 11));
+        char buf[Fraction::decimal_buffer_size(4)];
+        CHECK_EQ(std::string(buf, Fraction(2, 3).to_decimal(buf, 4)), "0.6667");
+
+        set_reciprocal_bound(DEFAULT_RECIPROCAL_BOUND);
+        CHECK_EQ(reciprocal_bound(), DEFAULT_RECIPROCAL_BOUND);
+        CHECK_EQ(Fraction(-6, -4), Fraction(3, 2));
+        CHECK_EQ(Fraction(0, -5).getDenominator(), 1);
+    }
+}
+
+TEST_SUITE("NUMA partitioned array tests")
+{
+    TEST_CASE("Partitions cover the array on block boundaries")
+    {
+        NumaFractionArray array(3 * PARALLEL_BLOCK + 100, 3);
+        CHECK_EQ(array.size(), 3 * PARALLEL_BLOCK + 100);
+        CHECK_EQ(array.partitions(), 3);
+        std::size_t expected_begin = 0;
+        for (std::size_t i = 0; i < array.partitions(); ++i)
+        {
+            const NumaPartitionInfo &info = array.partition_info(i);
+            CHECK_EQ(info.begin, expected_begin);
+            CHECK_EQ(info.begin % PARALLEL_BLOCK, 0);
+            CHECK_EQ(array.partition(i).size(), info.end - info.begin);
+            expected_begin = info.end;
+        }
+        CHECK_EQ(expected_begin, array.size());
+        CHECK(std::all_of(array.data().begin(), array.data().end(), [](const Fraction &value)
+                          { return value == Fraction{0, 1}; }));
+
+        // More workers than blocks are capped; an empty array still works
+        CHECK_EQ(NumaFractionArray(10, 8).partitions(), 1);
+        NumaFractionArray empty(0);
+        CHECK_EQ(empty.size(), 0);
+        CHECK_EQ(parallel_sum(empty.data(), empty.scheduler()), Fraction{0, 1});
+    }
+
+    TEST_CASE("Each partition is always processed by its own pinned worker")
+    {
+        NumaFractionArray array(4 * PARALLEL_BLOCK, 4);
+        std::vector<std::thread::id> first(array.partitions());
+        std::vector<std::thread::id> second(array.partitions());
+        array.for_each_partition([&](std::size_t index, std::span<Fraction> part)
+                                 {
+            first[index] = std::this_thread::get_id();
+            for (std::size_t i = 0; i < part.size(); ++i)
+            {
+                part[i] = Fraction(static_cast<int>(index + 1), static_cast<int>(i % 5 + 1));
+            }
+            const NumaPartitionInfo &info = array.partition_info(index);
+            if (info.pinned)
+            {
+                CHECK_EQ(sched_getcpu(), info.cpu);
+            } });
+        array.for_each_partition([&](std::size_t index, std::span<Fraction>)
+                                 { second[index] = std::this_thread::get_id(); });
+        CHECK(first == second);
+        CHECK(std::find(first.begin(), first.end(), std::this_thread::get_id()) == first.end());
+        CHECK_EQ(array[PARALLEL_BLOCK + 3], Fraction(2, 4));
+
+        CHECK_THROWS_AS(array.for_each_partition([](std::size_t index, std::span<Fraction>)
+                                                 {
+            if (index >= 2)
+            {
+                throw std::runtime_error("partition failed");
+            } }),
+                        std::runtime_error);
+    }
+
+    TEST_CASE("Parallel algorithms run partition-local through the scheduler")
+    {
+        NumaFractionArray array(5 * PARALLEL_BLOCK + 17, 3);
+        for (std::size_t i = 0; i < array.size(); ++i)
+        {
+            array[i] = Fraction(static_cast<int>(i % 3), 4);
+        }
+        CHECK_EQ(parallel_sum(array.data(), array.scheduler()), parallel_sum(array.data(), 1U));
+
+        std::vector<Fraction> expected(array.size());
+        StatusBitmap status;
+        parallel_inclusive_scan(array.data(), expected, status, 1U);
+        CHECK_EQ(parallel_inclusive_scan(array.data(), array.data(), status, array.scheduler()), 0);
+        CHECK(std::equal(expected.begin(), expected.end(), array.data().begin()));
+    }
+}
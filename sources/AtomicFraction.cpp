@@ -0,0 +1,73 @@
+#include "AtomicFraction.hpp"
+#include "FractionMath.hpp"
+
+using namespace std;
+namespace ariel
+{
+    AtomicFraction::AtomicFraction(const Fraction &initial) : word(pack(initial)) {}
+
+    Fraction AtomicFraction::load(std::memory_order order) const
+    {
+        return unpack(word.load(order));
+    }
+
+    void AtomicFraction::store(const Fraction &value, std::memory_order order)
+    {
+        word.store(pack(value), order);
+    }
+
+    Fraction AtomicFraction::exchange(const Fraction &value)
+    {
+        return unpack(word.exchange(pack(value)));
+    }
+
+    bool AtomicFraction::compare_exchange(Fraction &expected, const Fraction &desired)
+    {
+        uint64_t current = pack(expected);
+        bool swapped = word.compare_exchange_strong(current, pack(desired));
+        expected = unpack(current);
+        return swapped;
+    }
+
+    // CAS loop applying op to the current value; the result is computed outside any lock
+    template <typename Op>
+    static bool update(std::atomic<uint64_t> &word, const Fraction &operand, Fraction &previous, Op op)
+    {
+        uint64_t current = word.load(std::memory_order_relaxed);
+        while (true)
+        {
+            previous = unpack(current);
+            Fraction result;
+            if (!op(previous, operand, result))
+            {
+                return false;
+            }
+            if (word.compare_exchange_weak(current, pack(result), std::memory_order_acq_rel, std::memory_order_relaxed))
+            {
+                return true;
+            }
+        }
+    }
+
+    bool AtomicFraction::fetch_add(const Fraction &delta, Fraction &previous)
+    {
+        return update(word, delta, previous, checked_add);
+    }
+
+    bool AtomicFraction::fetch_mul(const Fraction &factor, Fraction &previous)
+    {
+        return update(word, factor, previous, checked_mul);
+    }
+
+    bool AtomicFraction::fetch_add(const Fraction &delta)
+    {
+        Fraction previous;
+        return fetch_add(delta, previous);
+    }
+
+    bool AtomicFraction::fetch_mul(const Fraction &factor)
+    {
+        Fraction previous;
+        return fetch_mul(factor, previous);
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "Fraction.hpp"
+
+namespace ariel
+{
+    // Lock-free shared fraction: the reduced pair lives in one 64-bit atomic word (see pack).
+    // Read-modify-write operations are CAS loops and never throw; an update whose result
+    // does not fit in int returns false and leaves the value unchanged.
+    class AtomicFraction
+    {
+    public:
+        AtomicFraction() = default;
+        explicit AtomicFraction(const Fraction &initial);
+
+        AtomicFraction(const AtomicFraction &) = delete;
+        AtomicFraction &operator=(const AtomicFraction &) = delete;
+
+        Fraction load(std::memory_order order = std::memory_order_seq_cst) const;
+        void store(const Fraction &value, std::memory_order order = std::memory_order_seq_cst);
+        Fraction exchange(const Fraction &value);
+        // On failure expected receives the current value
+        bool compare_exchange(Fraction &expected, const Fraction &desired);
+
+        // previous receives the value the update was applied to (or the current value on overflow)
+        bool fetch_add(const Fraction &delta, Fraction &previous);
+        bool fetch_mul(const Fraction &factor, Fraction &previous);
+        bool fetch_add(const Fraction &delta);
+        bool fetch_mul(const Fraction &factor);
+
+    private:
+        std::atomic<uint64_t> word{pack(Fraction())};
+    };
+}
@@ -0,0 +1,205 @@
+#include "DyadicFraction.hpp"
+#include "FractionMath.hpp"
+#include <bit>
+#include <climits>
+#include <cmath>
+#include <stdexcept>
+
+using namespace std;
+namespace ariel
+{
+    DyadicFraction::DyadicFraction(int64_t mantissa, int exponent) : mant(mantissa), exp(exponent)
+    {
+        normalize();
+    }
+
+    void DyadicFraction::normalize()
+    {
+        if (mant == 0)
+        {
+            exp = 0;
+            return;
+        }
+        int zeros = std::countr_zero(magnitude(mant));
+        mant >>= zeros;
+        exp += zeros;
+    }
+
+    DyadicFraction::DyadicFraction(const Fraction &fraction)
+    {
+        int64_t num = fraction.getNumerator();
+        int64_t den = fraction.getDenominator();
+        if (den < 0)
+        {
+            num = -num;
+            den = -den;
+        }
+        // Only the power-of-two part of the denominator can be cancelled by the numerator
+        int shared = std::min(std::countr_zero(magnitude(num)), std::countr_zero(static_cast<uint64_t>(den)));
+        den >>= shared;
+        if (num != 0 && !std::has_single_bit(static_cast<uint64_t>(den)))
+        {
+            throw std::invalid_argument("Fraction denominator is not a power of two");
+        }
+        mant = num >> shared;
+        exp = num == 0 ? 0 : -std::countr_zero(static_cast<uint64_t>(den));
+        normalize();
+    }
+
+    DyadicFraction DyadicFraction::from_double(double value)
+    {
+        if (!std::isfinite(value))
+        {
+            throw std::invalid_argument("Cannot convert inf or NaN to DyadicFraction");
+        }
+        int exponent = 0;
+        double fraction = std::frexp(value, &exponent);
+        // fraction * 2^53 is an integer of at most 53 bits
+        return {static_cast<int64_t>(std::ldexp(fraction, 53)), exponent - 53};
+    }
+
+    Fraction DyadicFraction::to_fraction() const
+    {
+        if (exp >= 0)
+        {
+            if (exp >= 31 || magnitude(mant) > (uint64_t{INT_MAX} >> exp))
+            {
+                throw std::overflow_error("DyadicFraction is too large for Fraction");
+            }
+            return Fraction::from_reduced(static_cast<int>(mant * (int64_t{1} << exp)), 1);
+        }
+        if (exp < -30 || mant > INT_MAX || mant < -INT_MAX)
+        {
+            throw std::overflow_error("DyadicFraction is too precise for Fraction");
+        }
+        // An odd mantissa over a power of two is already reduced
+        return Fraction::from_reduced(static_cast<int>(mant), 1 << -exp);
+    }
+
+    double DyadicFraction::to_double() const
+    {
+        return std::ldexp(static_cast<double>(mant), exp);
+    }
+
+    int64_t DyadicFraction::mantissa() const
+    {
+        return mant;
+    }
+
+    int DyadicFraction::exponent() const
+    {
+        return exp;
+    }
+
+    // mantissa << shift, false if bits would be lost (any shift of 63 or more)
+    static bool shift_left(int64_t mantissa, int64_t shift, int64_t &out)
+    {
+        if (mantissa == 0)
+        {
+            out = 0;
+            return true;
+        }
+        if (shift >= 63 || static_cast<int64_t>(std::bit_width(magnitude(mantissa))) + shift > 63)
+        {
+            return false;
+        }
+        out = mantissa * (int64_t{1} << shift);
+        return true;
+    }
+
+    static DyadicFraction aligned_sum(const DyadicFraction &lhs, const DyadicFraction &rhs, bool subtract)
+    {
+        // Both operands are brought to the smaller exponent; the gaps are taken in 64 bits
+        // since exponents may span the whole int range
+        int low = std::min(lhs.exponent(), rhs.exponent());
+        int64_t left = 0;
+        int64_t right = 0;
+        int64_t result = 0;
+        if (!shift_left(lhs.mantissa(), static_cast<int64_t>(lhs.exponent()) - low, left) ||
+            !shift_left(rhs.mantissa(), static_cast<int64_t>(rhs.exponent()) - low, right) ||
+            (subtract ? __builtin_sub_overflow(left, right, &result) : __builtin_add_overflow(left, right, &result)))
+        {
+            throw std::overflow_error(subtract ? "Overflow in subtraction operation" : "Overflow in addition operation");
+        }
+        return {result, low};
+    }
+
+    DyadicFraction DyadicFraction::operator+(const DyadicFraction &other) const
+    {
+        if (mant == 0)
+        {
+            return other;
+        }
+        if (other.mant == 0)
+        {
+            return *this;
+        }
+        return aligned_sum(*this, other, false);
+    }
+
+    DyadicFraction DyadicFraction::operator-(const DyadicFraction &other) const
+    {
+        return aligned_sum(*this, other, true);
+    }
+
+    DyadicFraction DyadicFraction::operator*(const DyadicFraction &other) const
+    {
+        int64_t product = 0;
+        int exponent = 0;
+        if (__builtin_mul_overflow(mant, other.mant, &product) || __builtin_add_overflow(exp, other.exp, &exponent))
+        {
+            throw std::overflow_error("Overflow in multiplication operation");
+        }
+        // Odd times odd is odd, so the product needs no normalization
+        DyadicFraction result;
+        result.mant = product;
+        result.exp = product == 0 ? 0 : exponent;
+        return result;
+    }
+
+    DyadicFraction DyadicFraction::operator-() const
+    {
+        if (mant == INT64_MIN)
+        {
+            throw std::overflow_error("Overflow in negation");
+        }
+        DyadicFraction result = *this;
+        result.mant = -mant;
+        return result;
+    }
+
+    std::strong_ordering DyadicFraction::operator<=>(const DyadicFraction &other) const
+    {
+        int sign = (mant > 0) - (mant < 0);
+        int other_sign = (other.mant > 0) - (other.mant < 0);
+        if (sign != other_sign || sign == 0)
+        {
+            return sign <=> other_sign;
+        }
+        // Same sign: compare the position of the top bit first, then the aligned magnitudes
+        uint64_t mag = magnitude(mant);
+        uint64_t other_mag = magnitude(other.mant);
+        int64_t top = static_cast<int64_t>(exp) + static_cast<int64_t>(std::bit_width(mag));
+        int64_t other_top = static_cast<int64_t>(other.exp) + static_cast<int64_t>(std::bit_width(other_mag));
+        std::strong_ordering by_magnitude = top <=> other_top;
+        if (top == other_top)
+        {
+            // Equal top bits mean the exponent gap is below 64, so the shift stays in range
+            if (exp > other.exp)
+            {
+                mag <<= static_cast<unsigned>(exp - other.exp);
+            }
+            else
+            {
+                other_mag <<= static_cast<unsigned>(other.exp - exp);
+            }
+            by_magnitude = mag <=> other_mag;
+        }
+        return sign > 0 ? by_magnitude : 0 <=> by_magnitude;
+    }
+
+    std::ostream &operator<<(std::ostream &ostr, const DyadicFraction &value)
+    {
+        return ostr << value.mant << "*2^" << value.exp;
+    }
+}
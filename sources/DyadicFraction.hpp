@@ -0,0 +1,47 @@
+#pragma once
+
+#include <compare>
+#include <cstdint>
+#include <iostream>
+
+#include "Fraction.hpp"
+
+namespace ariel
+{
+    // Rational with a power-of-two denominator: mantissa * 2^exponent. Every finite float or
+    // double is one exactly. Values are normalized by stripping trailing zero bits (ctz and a
+    // shift) instead of a gcd, add/sub align exponents by shifting and mul adds exponents.
+    class DyadicFraction
+    {
+    public:
+        DyadicFraction() = default;
+        DyadicFraction(int64_t mantissa, int exponent);
+
+        // Exact conversions. From Fraction: std::invalid_argument unless the reduced denominator
+        // is a power of two. To Fraction: std::overflow_error if the terms do not fit in int.
+        explicit DyadicFraction(const Fraction &fraction);
+        static DyadicFraction from_double(double value); // std::invalid_argument for inf/NaN
+        Fraction to_fraction() const;
+        double to_double() const; // exact while the mantissa fits in 53 bits
+
+        int64_t mantissa() const;
+        int exponent() const;
+
+        // std::overflow_error if an aligned mantissa or the product does not fit in 64 bits
+        DyadicFraction operator+(const DyadicFraction &other) const;
+        DyadicFraction operator-(const DyadicFraction &other) const;
+        DyadicFraction operator*(const DyadicFraction &other) const;
+        DyadicFraction operator-() const;
+
+        bool operator==(const DyadicFraction &other) const = default;
+        std::strong_ordering operator<=>(const DyadicFraction &other) const;
+
+        friend std::ostream &operator<<(std::ostream &ostr, const DyadicFraction &value);
+
+    private:
+        void normalize();
+
+        int64_t mant = 0;
+        int exp = 0;
+    };
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <compare>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+
+#include "Fraction.hpp"
+
+namespace ariel
+{
+    // Fraction with a compile-time denominator D (1000 for the float constructor's
+    // precision, 100 for cents, 90000 for video ticks). Only the numerator is stored,
+    // so a value is 4 bytes, and add/sub/compare are single integer ops with no gcd.
+    template <int D>
+    class FixedDenomFraction
+    {
+        static_assert(D > 0, "FixedDenomFraction needs a positive denominator");
+
+    public:
+        static constexpr int denominator = D;
+
+        constexpr FixedDenomFraction() = default;
+
+        // value == raw / D
+        static constexpr FixedDenomFraction from_raw(int raw)
+        {
+            FixedDenomFraction value;
+            value.numerator = raw;
+            return value;
+        }
+
+        // Exact conversion; std::invalid_argument if the fraction's denominator does not divide D
+        explicit FixedDenomFraction(const Fraction &fraction)
+        {
+            int64_t num = fraction.getNumerator();
+            int64_t den = fraction.getDenominator();
+            if (den < 0)
+            {
+                num = -num;
+                den = -den;
+            }
+            if (D % den != 0)
+            {
+                throw std::invalid_argument("Fraction is not a multiple of 1/D");
+            }
+            int64_t raw = num * (D / den);
+            if (raw > INT32_MAX || raw < INT32_MIN)
+            {
+                throw std::overflow_error("Fraction is too large for FixedDenomFraction");
+            }
+            numerator = static_cast<int>(raw);
+        }
+
+        constexpr int raw() const { return numerator; }
+        Fraction to_fraction() const { return Fraction(numerator, D); }
+
+        FixedDenomFraction operator+(FixedDenomFraction other) const
+        {
+            int raw_sum = 0;
+            if (__builtin_add_overflow(numerator, other.numerator, &raw_sum))
+            {
+                throw std::overflow_error("Overflow in addition operation");
+            }
+            return from_raw(raw_sum);
+        }
+
+        FixedDenomFraction operator-(FixedDenomFraction other) const
+        {
+            int raw_diff = 0;
+            if (__builtin_sub_overflow(numerator, other.numerator, &raw_diff))
+            {
+                throw std::overflow_error("Overflow in subtraction operation");
+            }
+            return from_raw(raw_diff);
+        }
+
+        FixedDenomFraction operator*(int factor) const
+        {
+            int raw_prod = 0;
+            if (__builtin_mul_overflow(numerator, factor, &raw_prod))
+            {
+                throw std::overflow_error("Overflow in multiplication operation");
+            }
+            return from_raw(raw_prod);
+        }
+
+        FixedDenomFraction &operator+=(FixedDenomFraction other) { return *this = *this + other; }
+        FixedDenomFraction &operator-=(FixedDenomFraction other) { return *this = *this - other; }
+        FixedDenomFraction operator-() const { return from_raw(0) - *this; }
+
+        constexpr bool operator==(const FixedDenomFraction &other) const = default;
+        constexpr auto operator<=>(const FixedDenomFraction &other) const = default;
+
+        friend std::ostream &operator<<(std::ostream &ostr, FixedDenomFraction value)
+        {
+            return ostr << value.to_fraction();
+        }
+
+    private:
+        int numerator = 0;
+    };
+}
@@ -1,8 +1,13 @@
 #include "Fraction.hpp"
+#include "FractionCache.hpp"
+#include "FractionMath.hpp"
 #include <iostream>
 #include <sstream>
 #include <cmath>
 #include <climits>
+#include <charconv>
+#include <cstdint>
+#include <algorithm>
 
 using namespace std;
 namespace ariel
@@ -48,8 +53,29 @@ namespace ariel
 
     // Arithmetic operators
 
+    // Operation cache hooks: a no-op unless the calling thread enabled the cache
+    static bool recall(OperationCache *cache, Operation oper, const Fraction &lhs, const Fraction &rhs, Fraction &result)
+    {
+        return cache != nullptr && cache->lookup(oper, pack(lhs), pack(rhs), result);
+    }
+
+    static void remember(OperationCache *cache, Operation oper, const Fraction &lhs, const Fraction &rhs, const Fraction &result)
+    {
+        if (cache != nullptr)
+        {
+            cache->store(oper, pack(lhs), pack(rhs), result);
+        }
+    }
+
     Fraction Fraction::operator+(const Fraction &other) const
     {
+        OperationCache *cache = active_operation_cache();
+        Fraction memo;
+        if (recall(cache, Operation::ADD, *this, other, memo))
+        {
+            return memo;
+        }
+
         int64_t num = static_cast<int64_t>(numerator) * other.denominator + static_cast<int64_t>(other.numerator) * denominator;
         int64_t den = static_cast<int64_t>(denominator) * other.denominator;
 
@@ -58,6 +84,7 @@ namespace ariel
         Fraction frac(static_cast<int>(num), static_cast<int>(den));
         frac.reduce();
 
+        remember(cache, Operation::ADD, *this, other, frac);
         return frac;
     }
 
@@ -65,16 +92,31 @@ namespace ariel
 
     Fraction Fraction::operator-(const Fraction &other) const
     {
+        OperationCache *cache = active_operation_cache();
+        Fraction memo;
+        if (recall(cache, Operation::SUB, *this, other, memo))
+        {
+            return memo;
+        }
+
         check_overflow(static_cast<int64_t>(numerator) * other.denominator, static_cast<int64_t>(other.numerator) * denominator, Operation::SUB);
         int num = numerator * other.denominator - other.numerator * denominator;
         int den = denominator * other.denominator;
         Fraction frac(num, den);
         frac.reduce();
+        remember(cache, Operation::SUB, *this, other, frac);
         return frac;
     }
 
     Fraction Fraction::operator*(const Fraction &other) const
     {
+        OperationCache *cache = active_operation_cache();
+        Fraction memo;
+        if (recall(cache, Operation::MUL, *this, other, memo))
+        {
+            return memo;
+        }
+
         check_overflow(numerator, other.numerator, Operation::MUL);
         check_overflow(denominator, other.denominator, Operation::MUL);
 
@@ -83,11 +125,19 @@ namespace ariel
 
         Fraction frac(newNumerator, newDenominator);
         frac.reduce();
+        remember(cache, Operation::MUL, *this, other, frac);
         return frac;
     }
 
     Fraction Fraction::operator/(const Fraction &other) const
     {
+        OperationCache *cache = active_operation_cache();
+        Fraction memo;
+        if (recall(cache, Operation::DIV, *this, other, memo))
+        {
+            return memo;
+        }
+
         if (other.numerator == 0 || other.denominator == 0)
         {
             throw std::runtime_error("Division by zero");
@@ -97,6 +147,7 @@ namespace ariel
         check_overflow(denominator, other.numerator, Operation::MUL);
         Fraction frac(numerator * other.denominator, denominator * other.numerator);
         frac.reduce();
+        remember(cache, Operation::DIV, *this, other, frac);
         return frac;
     }
     // Overloaded operator+ with Fraction and float operand
@@ -324,8 +375,52 @@ namespace ariel
         return ostr;
     }
 
+    // Index of the per-stream word holding the extraction mode (0 = throw)
+    static int extract_mode_index()
+    {
+        static const int index = std::ios_base::xalloc();
+        return index;
+    }
+
+    std::ios_base &nothrow_extract(std::ios_base &ios)
+    {
+        ios.iword(extract_mode_index()) = 1;
+        return ios;
+    }
+
+    std::ios_base &throw_extract(std::ios_base &ios)
+    {
+        ios.iword(extract_mode_index()) = 0;
+        return ios;
+    }
+
     istream &operator>>(istream &istr, Fraction &fraction)
     {
+        if (istr.iword(extract_mode_index()) != 0)
+        {
+            int num = 0;
+            int den = 0;
+            if (!(istr >> num >> den) || den == 0)
+            {
+                istr.setstate(ios::failbit);
+                return istr;
+            }
+            Fraction parsed;
+            parsed.numerator = num;
+            parsed.denominator = den;
+            try
+            {
+                parsed.reduce();
+            }
+            catch (const std::overflow_error &)
+            {
+                istr.setstate(ios::failbit);
+                return istr;
+            }
+            fraction = parsed;
+            return istr;
+        }
+
         if (!(istr >> fraction.numerator >> fraction.denominator))
         {
             throw std::runtime_error("Invalid input format");
@@ -339,16 +434,120 @@ namespace ariel
     }
 
     // Accessor functions for numerator and denominator
-    int Fraction::getNumerator() const
+    int Fraction::getNumerator() const noexcept
     {
         return numerator;
     }
 
-    int Fraction::getDenominator() const
+    int Fraction::getDenominator() const noexcept
     {
         return denominator;
     }
 
+    std::size_t Fraction::to_decimal(char *buf, int digits, RoundingMode mode) const
+    {
+        digits = std::max(digits, 0);
+        int64_t num = numerator;
+        int64_t den = denominator;
+        if (den < 0)
+        {
+            num = -num;
+            den = -den;
+        }
+        bool negative = num < 0;
+        auto rem = static_cast<uint64_t>(negative ? -num : num);
+        auto uden = static_cast<uint64_t>(den);
+        uint64_t whole = rem / uden;
+        rem %= uden;
+
+        // Leave room in front for a carry digit and the sign
+        char *first_digit = buf + 2;
+        char *out = std::to_chars(first_digit, first_digit + 10, whole).ptr;
+        char *point = out;
+        if (digits > 0)
+        {
+            *out++ = '.';
+        }
+        // Every digit divides by the same denominator; below 2^28, 10 * rem stays in 32 bits
+        // and small denominators go through the reciprocal table
+        const bool narrow = uden < (uint64_t{1} << 28U);
+        for (int i = 0; i < digits; ++i)
+        {
+            rem *= 10;
+            uint64_t digit = narrow ? divide_small(static_cast<uint32_t>(rem), static_cast<uint32_t>(uden)) : rem / uden;
+            *out++ = static_cast<char>('0' + digit);
+            rem -= digit * uden;
+        }
+
+        bool round_up = false;
+        switch (mode)
+        {
+        case RoundingMode::FLOOR:
+            round_up = negative && rem != 0;
+            break;
+        case RoundingMode::CEIL:
+            round_up = !negative && rem != 0;
+            break;
+        case RoundingMode::HALF_AWAY:
+            round_up = 2 * rem >= uden;
+            break;
+        case RoundingMode::HALF_EVEN:
+            round_up = 2 * rem > uden || (2 * rem == uden && ((*(out - 1) - '0') % 2) != 0);
+            break;
+        default:
+            break;
+        }
+
+        if (round_up)
+        {
+            // Propagate the carry leftwards, growing one digit if it reaches the front
+            char *pos = out - 1;
+            for (; pos >= first_digit; --pos)
+            {
+                if (pos == point)
+                {
+                    continue;
+                }
+                if (*pos != '9')
+                {
+                    ++*pos;
+                    break;
+                }
+                *pos = '0';
+            }
+            if (pos < first_digit)
+            {
+                *--first_digit = '1';
+            }
+        }
+
+        bool is_zero = std::all_of(first_digit, out, [](char chr) { return chr == '0' || chr == '.'; });
+        if (negative && !is_zero)
+        {
+            *--first_digit = '-';
+        }
+        auto length = static_cast<std::size_t>(out - first_digit);
+        if (first_digit != buf)
+        {
+            std::copy(first_digit, out, buf);
+        }
+        return length;
+    }
+
+    bool Fraction::has_terminating_decimal() const
+    {
+        int64_t den = std::abs(static_cast<int64_t>(denominator)) / std::abs(static_cast<int64_t>(gcd(numerator, denominator)));
+        while (den % 2 == 0)
+        {
+            den /= 2;
+        }
+        while (den % 5 == 0)
+        {
+            den /= 5;
+        }
+        return den == 1;
+    }
+
     int Fraction::gcd(int num_a, int num_b) const
     {
         if (num_b == 0)
@@ -395,15 +594,28 @@ namespace ariel
 
     void Fraction::reduce()
     {
-        int gcd_ = std::abs(Fraction::gcd(numerator, denominator));
-        numerator /= gcd_;
-        denominator /= gcd_;
-
-        if (denominator < 0)
+        // Binary gcd on the magnitudes, then division through the thread's reciprocal table
+        // when the gcd is small; coprime terms (gcd 1) skip the divisions entirely
+        auto num_mag = static_cast<uint32_t>(magnitude(numerator));
+        auto den_mag = static_cast<uint32_t>(magnitude(denominator));
+        uint32_t gcd_ = binary_gcd_t(num_mag, den_mag);
+        if (gcd_ > 1)
+        {
+            num_mag = divide_small(num_mag, gcd_);
+            den_mag = divide_small(den_mag, gcd_);
+        }
+        else if (gcd_ == 0)
+        {
+            return;
+        }
+        const bool negative = (numerator < 0) != (denominator < 0);
+        // A magnitude of 2^31 only fits as a negative numerator (e.g. 1/INT_MIN does not)
+        if (den_mag > INT_MAX || num_mag > (negative ? 1U + INT_MAX : INT_MAX))
         {
-            numerator = -numerator;
-            denominator = -denominator;
+            throw std::overflow_error("Reduced fraction does not fit in int");
         }
+        numerator = static_cast<int>(negative ? -static_cast<int64_t>(num_mag) : static_cast<int64_t>(num_mag));
+        denominator = static_cast<int>(den_mag);
     }
 
 } // namespace ariel
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <type_traits>
 
 constexpr float EPSILON = 0.0001F;
 
@@ -10,9 +14,25 @@ namespace ariel
     {
         ADD,
         SUB,
-        MUL
+        MUL,
+        DIV
     };
 
+    // Rounding applied to the last digit of Fraction::to_decimal
+    enum class RoundingMode
+    {
+        TRUNCATE,  // toward zero
+        FLOOR,     // toward negative infinity
+        CEIL,      // toward positive infinity
+        HALF_AWAY, // to nearest, ties away from zero
+        HALF_EVEN  // to nearest, ties to even
+    };
+
+    // Stream manipulators selecting how operator>> reports malformed input.
+    // In nothrow mode a bad record sets failbit and leaves the fraction unchanged.
+    std::ios_base &nothrow_extract(std::ios_base &ios);
+    std::ios_base &throw_extract(std::ios_base &ios);
+
     class Fraction
     {
     public:
@@ -20,6 +40,11 @@ namespace ariel
         Fraction(int numerator, int denominator);
         Fraction(float number);
 
+        // Builds a fraction from terms that are already reduced with a positive
+        // denominator, skipping validation and gcd (packed storage and transport paths)
+        static Fraction from_reduced(int numerator, int denominator);
+        friend uint64_t pack(const Fraction &fraction);
+
         // Arithmetic operators
         Fraction operator+(const Fraction &other) const;
         Fraction operator-(const Fraction &other) const;
@@ -67,8 +92,18 @@ namespace ariel
         friend std::istream &operator>>(std::istream &istr, Fraction &fraction);
 
         // Accessor functions for numerator and denominator
-        int getNumerator() const;
-        int getDenominator() const;
+        int getNumerator() const noexcept;
+        int getDenominator() const noexcept;
+
+        // Fixed-point rendering by integer long division, no floating point involved.
+        // Writes at most decimal_buffer_size(digits) chars (no terminating NUL) and returns the count.
+        std::size_t to_decimal(char *buf, int digits, RoundingMode mode = RoundingMode::HALF_AWAY) const;
+        static constexpr std::size_t decimal_buffer_size(int digits)
+        {
+            return 13 + static_cast<std::size_t>(digits < 0 ? 0 : digits);
+        }
+        // True if the decimal expansion terminates (denominator has no prime factors but 2 and 5)
+        bool has_terminating_decimal() const;
 
         void check_overflow(int64_t num_a, int64_t num_b, Operation oper) const;
         int gcd(int num_a, int num_b) const;
@@ -80,4 +115,51 @@ namespace ariel
         int denominator;
     };
 
-}
\ No newline at end of file
+    // Fractions are copied as plain bytes by the batch kernels, packed words, shared-memory
+    // rings and the std::execution algorithms, so this must not regress
+    static_assert(std::is_trivially_copyable_v<Fraction> && std::is_standard_layout_v<Fraction>,
+                  "Fraction must stay trivially copyable and standard-layout");
+
+    inline Fraction Fraction::from_reduced(int numerator, int denominator)
+    {
+        Fraction fraction;
+        fraction.numerator = numerator;
+        fraction.denominator = denominator;
+        return fraction;
+    }
+
+    // One 64-bit word per fraction: numerator in the high half, denominator in the low half
+    inline uint64_t pack(const Fraction &fraction)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(fraction.numerator)) << 32U) |
+               static_cast<uint32_t>(fraction.denominator);
+    }
+
+    inline Fraction unpack(uint64_t word)
+    {
+        return Fraction::from_reduced(static_cast<int>(static_cast<uint32_t>(word >> 32U)),
+                                      static_cast<int>(static_cast<uint32_t>(word)));
+    }
+
+    // Mixes a packed fraction into a well-distributed hash (murmur3 finalizer)
+    inline uint64_t hash_packed(uint64_t word)
+    {
+        word ^= word >> 33U;
+        word *= 0xff51afd7ed558ccdULL;
+        word ^= word >> 33U;
+        word *= 0xc4ceb9fe1a85ec53ULL;
+        word ^= word >> 33U;
+        return word;
+    }
+
+}
+
+// Hash of the canonical reduced form, consistent with operator==
+template <>
+struct std::hash<ariel::Fraction>
+{
+    std::size_t operator()(const ariel::Fraction &fraction) const noexcept
+    {
+        return static_cast<std::size_t>(ariel::hash_packed(ariel::pack(fraction)));
+    }
+};
\ No newline at end of file
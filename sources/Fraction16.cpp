@@ -0,0 +1,53 @@
+#include "Fraction16.hpp"
+#include <stdexcept>
+
+using namespace std;
+namespace ariel
+{
+    bool Fraction16::fits(const Fraction &fraction)
+    {
+        // One unsigned compare per term: shift the numerator's range to [0, 65535]. The
+        // offsets are applied after the conversion so they wrap instead of overflowing int.
+        return static_cast<uint32_t>(fraction.getNumerator()) + 32768U <= UINT16_MAX &&
+               static_cast<uint32_t>(fraction.getDenominator()) - 1U < UINT16_MAX;
+    }
+
+    bool Fraction16::try_narrow(const Fraction &fraction, Fraction16 &out)
+    {
+        if (!fits(fraction))
+        {
+            return false;
+        }
+        out.numerator = static_cast<int16_t>(fraction.getNumerator());
+        out.denominator = static_cast<uint16_t>(fraction.getDenominator());
+        return true;
+    }
+
+    Fraction16::Fraction16(const Fraction &fraction)
+    {
+        if (!try_narrow(fraction, *this))
+        {
+            throw std::overflow_error("Fraction does not fit in Fraction16");
+        }
+    }
+
+    std::size_t pack16(std::span<const Fraction> in, std::span<Fraction16> out)
+    {
+        for (std::size_t i = 0; i < in.size(); ++i)
+        {
+            if (!Fraction16::try_narrow(in[i], out[i]))
+            {
+                return i;
+            }
+        }
+        return in.size();
+    }
+
+    void unpack16(std::span<const Fraction16> in, std::span<Fraction> out)
+    {
+        for (std::size_t i = 0; i < in.size(); ++i)
+        {
+            out[i] = in[i].widen();
+        }
+    }
+}
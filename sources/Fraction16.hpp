@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "Fraction.hpp"
+
+namespace ariel
+{
+    // Compact 4-byte storage for a reduced fraction whose numerator fits in int16 and whose
+    // denominator is at most 65535. Not an arithmetic type: narrow for storage, widen to
+    // Fraction to compute.
+    class Fraction16
+    {
+    public:
+        Fraction16() = default;
+        // std::overflow_error if the terms do not fit
+        explicit Fraction16(const Fraction &fraction);
+        // Non-throwing checked narrowing
+        static bool fits(const Fraction &fraction);
+        static bool try_narrow(const Fraction &fraction, Fraction16 &out);
+
+        Fraction widen() const { return Fraction::from_reduced(numerator, denominator); }
+        int16_t getNumerator() const { return numerator; }
+        uint16_t getDenominator() const { return denominator; }
+
+        bool operator==(const Fraction16 &other) const = default;
+
+    private:
+        int16_t numerator = 0;
+        uint16_t denominator = 1;
+    };
+
+    // Batch kernels. pack16 stops at the first element that does not fit and returns its index
+    // (in.size() when everything was packed); out must be at least as long as in.
+    std::size_t pack16(std::span<const Fraction> in, std::span<Fraction16> out);
+    void unpack16(std::span<const Fraction16> in, std::span<Fraction> out);
+}
@@ -0,0 +1,160 @@
+#include "FractionBatch.hpp"
+#include "FractionMath.hpp"
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+using namespace std;
+namespace ariel
+{
+    // Low bit of every 2-bit status field
+    constexpr uint64_t LOW_BITS = 0x5555555555555555ULL;
+
+    StatusBitmap::StatusBitmap(std::size_t size)
+    {
+        resize(size);
+    }
+
+    void StatusBitmap::resize(std::size_t size)
+    {
+        count = size;
+        bits.assign((size + PER_WORD - 1) / PER_WORD, 0);
+    }
+
+    void StatusBitmap::set(std::size_t index, FractionStatus status)
+    {
+        uint64_t &word = bits[index / PER_WORD];
+        const std::size_t shift = index % PER_WORD * 2;
+        word = (word & ~(uint64_t{3} << shift)) | (static_cast<uint64_t>(status) << shift);
+    }
+
+    bool StatusBitmap::all_ok() const
+    {
+        return std::all_of(bits.begin(), bits.end(), [](uint64_t word)
+                           { return word == 0; });
+    }
+
+    std::size_t StatusBitmap::count_of(FractionStatus status) const
+    {
+        // Select the matching bit of each field, shifted down to the field's low bit
+        const uint64_t mask = static_cast<uint64_t>(status) == 2 ? LOW_BITS << 1U : LOW_BITS;
+        const unsigned shift = static_cast<uint64_t>(status) == 2 ? 1U : 0U;
+        std::size_t total = 0;
+        for (uint64_t word : bits)
+        {
+            total += static_cast<std::size_t>(std::popcount((word & mask) >> shift));
+        }
+        return total;
+    }
+
+    std::size_t StatusBitmap::first_error() const
+    {
+        for (std::size_t i = 0; i < bits.size(); ++i)
+        {
+            if (bits[i] != 0)
+            {
+                return i * PER_WORD + static_cast<std::size_t>(std::countr_zero(bits[i])) / 2;
+            }
+        }
+        return count;
+    }
+
+    enum class BatchOp
+    {
+        ADD,
+        SUB,
+        MUL,
+        DIV
+    };
+
+    // One status word per 32 elements, built in a register and stored once. The loop has
+    // no exception paths: every outcome is a status code.
+    template <BatchOp Op>
+    static std::size_t elementwise(std::span<const Fraction> lhs, std::span<const Fraction> rhs, std::span<Fraction> out, StatusBitmap &status)
+    {
+        if (rhs.size() != lhs.size() || out.size() < lhs.size())
+        {
+            throw std::invalid_argument("Batch operand sizes differ");
+        }
+        status.resize(lhs.size());
+        std::span<uint64_t> words = status.words();
+        std::size_t failed = 0;
+        for (std::size_t first = 0; first < lhs.size(); first += StatusBitmap::PER_WORD)
+        {
+            const std::size_t last = std::min(lhs.size(), first + StatusBitmap::PER_WORD);
+            uint64_t word = 0;
+            for (std::size_t i = first; i < last; ++i)
+            {
+                const int64_t a_n = lhs[i].getNumerator();
+                const int64_t a_d = lhs[i].getDenominator();
+                const int64_t b_n = rhs[i].getNumerator();
+                const int64_t b_d = rhs[i].getDenominator();
+                int64_t num = 0;
+                int64_t den = 0;
+                bool wrapped = false;
+                switch (Op)
+                {
+                case BatchOp::ADD:
+                    wrapped = __builtin_add_overflow(a_n * b_d, b_n * a_d, &num);
+                    den = a_d * b_d;
+                    break;
+                case BatchOp::SUB:
+                    wrapped = __builtin_sub_overflow(a_n * b_d, b_n * a_d, &num);
+                    den = a_d * b_d;
+                    break;
+                case BatchOp::MUL:
+                    num = a_n * b_n;
+                    den = a_d * b_d;
+                    break;
+                case BatchOp::DIV:
+                    num = a_n * b_d;
+                    den = a_d * b_n;
+                    break;
+                }
+                if (den < 0)
+                {
+                    num = -num;
+                    den = -den;
+                }
+                int out_num = 0;
+                int out_den = 1;
+                FractionStatus code = FractionStatus::OK;
+                if (den == 0)
+                {
+                    code = FractionStatus::DIVIDED_BY_ZERO;
+                }
+                else if (wrapped || !reduce_to_int(num, den, out_num, out_den))
+                {
+                    code = FractionStatus::OVERFLOWED;
+                    out_num = 0;
+                    out_den = 1;
+                }
+                out[i] = Fraction::from_reduced(out_num, out_den);
+                word |= static_cast<uint64_t>(code) << ((i - first) * 2);
+            }
+            words[first / StatusBitmap::PER_WORD] = word;
+            failed += static_cast<std::size_t>(std::popcount((word | word >> 1U) & LOW_BITS));
+        }
+        return failed;
+    }
+
+    std::size_t add(std::span<const Fraction> lhs, std::span<const Fraction> rhs, std::span<Fraction> out, StatusBitmap &status)
+    {
+        return elementwise<BatchOp::ADD>(lhs, rhs, out, status);
+    }
+
+    std::size_t sub(std::span<const Fraction> lhs, std::span<const Fraction> rhs, std::span<Fraction> out, StatusBitmap &status)
+    {
+        return elementwise<BatchOp::SUB>(lhs, rhs, out, status);
+    }
+
+    std::size_t mul(std::span<const Fraction> lhs, std::span<const Fraction> rhs, std::span<Fraction> out, StatusBitmap &status)
+    {
+        return elementwise<BatchOp::MUL>(lhs, rhs, out, status);
+    }
+
+    std::size_t div(std::span<const Fraction> lhs, std::span<const Fraction> rhs, std::span<Fraction> out, StatusBitmap &status)
+    {
+        return elementwise<BatchOp::DIV>(lhs, rhs, out, status);
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Fraction.hpp"
+#include "StickyFraction.hpp"
+
+namespace ariel
+{
+    // Per-element FractionStatus packed two bits per element, 32 elements per word
+    class StatusBitmap
+    {
+    public:
+        StatusBitmap() = default;
+        explicit StatusBitmap(std::size_t size);
+
+        std::size_t size() const { return count; }
+        // Clears every status to OK
+        void resize(std::size_t size);
+        FractionStatus operator[](std::size_t index) const
+        {
+            return static_cast<FractionStatus>((bits[index / PER_WORD] >> (index % PER_WORD * 2)) & 3U);
+        }
+        void set(std::size_t index, FractionStatus status);
+
+        bool all_ok() const;
+        // Elements whose status includes the given flag
+        std::size_t count_of(FractionStatus status) const;
+        // Index of the first element that is not OK, or size()
+        std::size_t first_error() const;
+
+        std::span<uint64_t> words() { return bits; }
+        std::span<const uint64_t> words() const { return bits; }
+
+        static constexpr std::size_t PER_WORD = 32;
+
+    private:
+        std::vector<uint64_t> bits;
+        std::size_t count = 0;
+    };
+
+    // Non-throwing elementwise kernels over spans: out[i] = lhs[i] op rhs[i], with the
+    // outcome of each element recorded in status (resized to lhs.size()). A failed element
+    // is written as 0/1; the others are unaffected, so one overflow no longer discards the
+    // batch. Return the number of failed elements. Only mismatched sizes throw
+    // (std::invalid_argument), before any element is computed; out may alias lhs or rhs.
+    std::size_t add(std::span<const Fraction> lhs, std::span<const Fraction> rhs, std::span<Fraction> out, StatusBitmap &status);
+    std::size_t sub(std::span<const Fraction> lhs, std::span<const Fraction> rhs, std::span<Fraction> out, StatusBitmap &status);
+    std::size_t mul(std::span<const Fraction> lhs, std::span<const Fraction> rhs, std::span<Fraction> out, StatusBitmap &status);
+    std::size_t div(std::span<const Fraction> lhs, std::span<const Fraction> rhs, std::span<Fraction> out, StatusBitmap &status);
+}
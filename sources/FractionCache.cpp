@@ -0,0 +1,123 @@
+#include "FractionCache.hpp"
+#include <algorithm>
+#include <bit>
+#include <memory>
+
+using namespace std;
+namespace ariel
+{
+    namespace detail
+    {
+        constinit thread_local OperationCache *active_operation_cache = nullptr;
+    }
+
+    static std::unique_ptr<OperationCache> &owned_cache()
+    {
+        thread_local std::unique_ptr<OperationCache> cache;
+        return cache;
+    }
+
+    OperationCache::OperationCache(std::size_t capacity)
+        : slots(std::bit_ceil(capacity == 0 ? std::size_t{1} : capacity), Slot{0, 0, 0, Operation::ADD}) {}
+
+    // Golden-ratio multiplier spreading the operation id across the key bits
+    constexpr uint64_t OPERATION_SALT = 0x9e3779b97f4a7c15ULL;
+
+    static std::size_t slot_index(Operation oper, uint64_t lhs, uint64_t rhs, std::size_t mask)
+    {
+        uint64_t key = lhs ^ ((rhs << 23U) | (rhs >> 41U)) ^ (static_cast<uint64_t>(oper) * OPERATION_SALT);
+        return static_cast<std::size_t>(hash_packed(key)) & mask;
+    }
+
+    bool OperationCache::lookup(Operation oper, uint64_t lhs, uint64_t rhs, Fraction &result)
+    {
+        const Slot &slot = slots[slot_index(oper, lhs, rhs, slots.size() - 1)];
+        bool hit = slot.lhs == lhs && slot.rhs == rhs && slot.oper == oper;
+        if (hit)
+        {
+            ++hit_count;
+            ++window_hits;
+            result = unpack(slot.result);
+        }
+        else
+        {
+            ++miss_count;
+        }
+
+        if (++window_lookups == window)
+        {
+            if (static_cast<double>(window_hits) < min_hit_rate * static_cast<double>(window))
+            {
+                is_active = false;
+                if (detail::active_operation_cache == this)
+                {
+                    detail::active_operation_cache = nullptr;
+                }
+            }
+            window_hits = 0;
+            window_lookups = 0;
+        }
+        return hit;
+    }
+
+    void OperationCache::store(Operation oper, uint64_t lhs, uint64_t rhs, const Fraction &result)
+    {
+        slots[slot_index(oper, lhs, rhs, slots.size() - 1)] = Slot{lhs, rhs, pack(result), oper};
+    }
+
+    void OperationCache::set_policy(uint64_t window, double min_hit_rate)
+    {
+        this->window = std::max<uint64_t>(window, 1);
+        this->min_hit_rate = min_hit_rate;
+        window_hits = 0;
+        window_lookups = 0;
+    }
+
+    bool OperationCache::active() const
+    {
+        return is_active;
+    }
+
+    uint64_t OperationCache::hits() const
+    {
+        return hit_count;
+    }
+
+    uint64_t OperationCache::misses() const
+    {
+        return miss_count;
+    }
+
+    double OperationCache::hit_rate() const
+    {
+        uint64_t total = hit_count + miss_count;
+        return total == 0 ? 0.0 : static_cast<double>(hit_count) / static_cast<double>(total);
+    }
+
+    void OperationCache::clear()
+    {
+        std::fill(slots.begin(), slots.end(), Slot{0, 0, 0, Operation::ADD});
+        hit_count = 0;
+        miss_count = 0;
+        window_hits = 0;
+        window_lookups = 0;
+    }
+
+    void enable_operation_cache(std::size_t capacity, uint64_t window, double min_hit_rate)
+    {
+        std::unique_ptr<OperationCache> &cache = owned_cache();
+        cache = std::make_unique<OperationCache>(capacity);
+        cache->set_policy(window, min_hit_rate);
+        detail::active_operation_cache = cache.get();
+    }
+
+    void disable_operation_cache()
+    {
+        detail::active_operation_cache = nullptr;
+    }
+
+    OperationCache *thread_operation_cache()
+    {
+        return owned_cache().get();
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Fraction.hpp"
+
+namespace ariel
+{
+    // Bounded direct-mapped memo of (lhs, operation, rhs) -> result for the Fraction
+    // arithmetic operators. Opt-in per thread; while enabled, operator+ - * / consult
+    // it before doing any overflow checks or gcd work.
+    class OperationCache
+    {
+    public:
+        explicit OperationCache(std::size_t capacity = DEFAULT_CAPACITY);
+
+        bool lookup(Operation oper, uint64_t lhs, uint64_t rhs, Fraction &result);
+        void store(Operation oper, uint64_t lhs, uint64_t rhs, const Fraction &result);
+
+        // Every `window` lookups the window's hit rate is checked; below min_hit_rate the
+        // cache switches itself off so cold workloads go back to the plain operators
+        void set_policy(uint64_t window, double min_hit_rate);
+        bool active() const;
+
+        uint64_t hits() const;
+        uint64_t misses() const;
+        double hit_rate() const;
+        void clear();
+
+        static constexpr std::size_t DEFAULT_CAPACITY = 1024;
+        static constexpr uint64_t DEFAULT_WINDOW = 4096;
+        static constexpr double DEFAULT_MIN_HIT_RATE = 0.05;
+
+    private:
+        struct Slot
+        {
+            uint64_t lhs; // 0 (a zero denominator) marks an empty slot
+            uint64_t rhs;
+            uint64_t result;
+            Operation oper;
+        };
+
+        std::vector<Slot> slots;
+        uint64_t hit_count = 0;
+        uint64_t miss_count = 0;
+        uint64_t window = DEFAULT_WINDOW;
+        uint64_t window_hits = 0;
+        uint64_t window_lookups = 0;
+        double min_hit_rate = DEFAULT_MIN_HIT_RATE;
+        bool is_active = true;
+    };
+
+    // Turns the calling thread's cache on (resetting it) or off
+    void enable_operation_cache(std::size_t capacity = OperationCache::DEFAULT_CAPACITY,
+                                uint64_t window = OperationCache::DEFAULT_WINDOW,
+                                double min_hit_rate = OperationCache::DEFAULT_MIN_HIT_RATE);
+    void disable_operation_cache();
+    // The calling thread's cache for statistics, or nullptr if it was never enabled
+    OperationCache *thread_operation_cache();
+
+    namespace detail
+    {
+        extern constinit thread_local OperationCache *active_operation_cache;
+    }
+
+    // Cache the operators should consult right now, or nullptr
+    inline OperationCache *active_operation_cache()
+    {
+        return detail::active_operation_cache;
+    }
+}
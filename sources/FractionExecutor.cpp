@@ -0,0 +1,201 @@
+#include "FractionExecutor.hpp"
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+namespace ariel
+{
+    FractionExecutor::FractionExecutor(unsigned threads)
+    {
+        if (threads == 0)
+        {
+            threads = std::max(1U, std::thread::hardware_concurrency());
+        }
+        for (unsigned i = 0; i < threads; ++i)
+        {
+            workers.push_back(std::make_unique<Worker>());
+        }
+        for (unsigned i = 0; i < threads; ++i)
+        {
+            pool.emplace_back(&FractionExecutor::work, this, i);
+        }
+    }
+
+    FractionExecutor::~FractionExecutor()
+    {
+        {
+            std::lock_guard<std::mutex> guard(state_lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &thread : pool)
+        {
+            thread.join();
+        }
+    }
+
+    unsigned FractionExecutor::thread_count() const
+    {
+        return static_cast<unsigned>(workers.size());
+    }
+
+    bool FractionExecutor::take(unsigned self, std::size_t &task)
+    {
+        {
+            Worker &own = *workers[self];
+            std::lock_guard<std::mutex> guard(own.lock);
+            if (!own.tasks.empty())
+            {
+                task = own.tasks.back();
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        // Steal the oldest task of the next non-empty deque: it is the furthest from
+        // what its owner is working on, and taking from the front avoids owner contention
+        for (std::size_t offset = 1; offset < workers.size(); ++offset)
+        {
+            Worker &victim = *workers[(self + offset) % workers.size()];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.tasks.empty())
+            {
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+                workers[self]->steals.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void FractionExecutor::execute(unsigned self, std::size_t task)
+    {
+        try
+        {
+            (*current)(task);
+        }
+        catch (...)
+        {
+            errors[task] = std::current_exception();
+        }
+        workers[self]->executed.fetch_add(1, std::memory_order_relaxed);
+        if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            std::lock_guard<std::mutex> guard(state_lock);
+            done.notify_all();
+        }
+    }
+
+    void FractionExecutor::work(unsigned self)
+    {
+        std::uint64_t seen = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> guard(state_lock);
+                wake.wait(guard, [&]
+                          { return stopping || generation != seen; });
+                if (stopping)
+                {
+                    return;
+                }
+                seen = generation;
+            }
+            std::size_t task = 0;
+            while (take(self, task))
+            {
+                execute(self, task);
+            }
+        }
+    }
+
+    void FractionExecutor::run(std::size_t tasks, const std::function<void(std::size_t)> &task)
+    {
+        if (tasks == 0)
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> batch(batch_lock);
+        auto start = std::chrono::steady_clock::now();
+        current = &task;
+        errors.assign(tasks, nullptr);
+        pending.store(tasks, std::memory_order_relaxed);
+
+        // Contiguous ranges keep neighbouring chunks on one worker until stealing kicks in
+        const std::size_t count = workers.size();
+        for (std::size_t worker = 0; worker < count; ++worker)
+        {
+            std::lock_guard<std::mutex> guard(workers[worker]->lock);
+            for (std::size_t i = tasks * worker / count; i < tasks * (worker + 1) / count; ++i)
+            {
+                workers[worker]->tasks.push_back(i);
+            }
+        }
+        {
+            std::unique_lock<std::mutex> guard(state_lock);
+            ++generation;
+            wake.notify_all();
+            done.wait(guard, [&]
+                      { return pending.load(std::memory_order_acquire) == 0; });
+        }
+        current = nullptr;
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        nanoseconds.fetch_add(static_cast<std::uint64_t>(elapsed.count()), std::memory_order_relaxed);
+        batches.fetch_add(1, std::memory_order_relaxed);
+        for (const std::exception_ptr &error : errors)
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    void FractionExecutor::for_each_chunk(std::span<Fraction> data, std::size_t chunk,
+                                          const std::function<void(std::span<Fraction>)> &func)
+    {
+        chunk = std::max<std::size_t>(chunk, 1);
+        items.fetch_add(data.size(), std::memory_order_relaxed);
+        run((data.size() + chunk - 1) / chunk, [&](std::size_t i)
+            { func(data.subspan(i * chunk, std::min(chunk, data.size() - i * chunk))); });
+    }
+
+    void FractionExecutor::for_each_chunk(std::span<const Fraction> data, std::size_t chunk,
+                                          const std::function<void(std::span<const Fraction>)> &func)
+    {
+        chunk = std::max<std::size_t>(chunk, 1);
+        items.fetch_add(data.size(), std::memory_order_relaxed);
+        run((data.size() + chunk - 1) / chunk, [&](std::size_t i)
+            { func(data.subspan(i * chunk, std::min(chunk, data.size() - i * chunk))); });
+    }
+
+    ExecutorStats FractionExecutor::stats() const
+    {
+        ExecutorStats result;
+        result.batches = batches.load(std::memory_order_relaxed);
+        result.items = items.load(std::memory_order_relaxed);
+        result.seconds = static_cast<double>(nanoseconds.load(std::memory_order_relaxed)) * 1e-9;
+        for (const std::unique_ptr<Worker> &worker : workers)
+        {
+            ExecutorWorkerStats entry{worker->executed.load(std::memory_order_relaxed),
+                                      worker->steals.load(std::memory_order_relaxed)};
+            result.tasks += entry.tasks;
+            result.steals += entry.steals;
+            result.workers.push_back(entry);
+        }
+        return result;
+    }
+
+    void FractionExecutor::reset_stats()
+    {
+        batches.store(0, std::memory_order_relaxed);
+        items.store(0, std::memory_order_relaxed);
+        nanoseconds.store(0, std::memory_order_relaxed);
+        for (const std::unique_ptr<Worker> &worker : workers)
+        {
+            worker->executed.store(0, std::memory_order_relaxed);
+            worker->steals.store(0, std::memory_order_relaxed);
+        }
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "Fraction.hpp"
+
+namespace ariel
+{
+    struct ExecutorWorkerStats
+    {
+        std::uint64_t tasks = 0;
+        // Tasks this worker took from another worker's deque
+        std::uint64_t steals = 0;
+    };
+
+    struct ExecutorStats
+    {
+        std::uint64_t batches = 0;
+        std::uint64_t tasks = 0;
+        std::uint64_t steals = 0;
+        // Fractions handed to for_each_chunk callables
+        std::uint64_t items = 0;
+        // Wall time spent inside run(), across batches
+        double seconds = 0;
+        std::vector<ExecutorWorkerStats> workers;
+
+        double items_per_second() const { return seconds > 0 ? static_cast<double>(items) / seconds : 0; }
+    };
+
+    // Fixed pool of workers for batches of independent tasks whose cost is uneven (a chunk
+    // full of large terms spends far longer in gcd). A batch is dealt out as contiguous
+    // index ranges, one per worker deque; owners pop from the back of their own deque and
+    // idle workers steal from the front of the others. Batches run one at a time; run()
+    // blocks until the batch is done and rethrows the exception of the lowest failing task.
+    class FractionExecutor
+    {
+    public:
+        // 0: hardware concurrency
+        explicit FractionExecutor(unsigned threads = 0);
+        ~FractionExecutor();
+
+        FractionExecutor(const FractionExecutor &) = delete;
+        FractionExecutor &operator=(const FractionExecutor &) = delete;
+
+        unsigned thread_count() const;
+
+        void run(std::size_t tasks, const std::function<void(std::size_t)> &task);
+        // Calls func on consecutive chunks of at most `chunk` elements, in any order
+        void for_each_chunk(std::span<Fraction> data, std::size_t chunk,
+                            const std::function<void(std::span<Fraction>)> &func);
+        void for_each_chunk(std::span<const Fraction> data, std::size_t chunk,
+                            const std::function<void(std::span<const Fraction>)> &func);
+
+        ExecutorStats stats() const;
+        void reset_stats();
+
+    private:
+        struct alignas(64) Worker
+        {
+            std::mutex lock;
+            std::deque<std::size_t> tasks;
+            std::atomic<std::uint64_t> executed{0};
+            std::atomic<std::uint64_t> steals{0};
+        };
+
+        void work(unsigned self);
+        bool take(unsigned self, std::size_t &task);
+        void execute(unsigned self, std::size_t task);
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::vector<std::thread> pool;
+
+        // One batch at a time
+        std::mutex batch_lock;
+        const std::function<void(std::size_t)> *current = nullptr;
+        std::atomic<std::size_t> pending{0};
+        std::vector<std::exception_ptr> errors;
+
+        // Wakes workers for a new batch and the caller when it completes
+        std::mutex state_lock;
+        std::condition_variable wake;
+        std::condition_variable done;
+        std::uint64_t generation = 0;
+        bool stopping = false;
+
+        std::atomic<std::uint64_t> batches{0};
+        std::atomic<std::uint64_t> items{0};
+        std::atomic<std::uint64_t> nanoseconds{0};
+    };
+}
@@ -0,0 +1,371 @@
+#include "FractionIO.hpp"
+#include "FractionMath.hpp"
+#include <charconv>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+namespace ariel
+{
+    static bool is_space(char chr)
+    {
+        return chr == ' ' || chr == '\t' || chr == '\r' || chr == '\n' || chr == '\v' || chr == '\f';
+    }
+
+    static const char *skip_spaces(const char *first, const char *last)
+    {
+        while (first != last && is_space(*first))
+        {
+            ++first;
+        }
+        return first;
+    }
+
+    // Parses one int token; returns nullptr if the token is missing or malformed
+    static const char *parse_int(const char *first, const char *last, int &value)
+    {
+        first = skip_spaces(first, last);
+        if (first != last && *first == '+')
+        {
+            // from_chars would still take a sign after it, as in "+-5"
+            ++first;
+            if (first == last || *first < '0' || *first > '9')
+            {
+                return nullptr;
+            }
+        }
+        auto [ptr, err] = std::from_chars(first, last, value);
+        if (err != std::errc() || (ptr != last && !is_space(*ptr)))
+        {
+            return nullptr;
+        }
+        return ptr;
+    }
+
+    ReadStats read_fractions(std::istream &istr, std::vector<Fraction> &out, std::size_t max_records)
+    {
+        ReadStats stats;
+        std::string line;
+        while (stats.records < max_records && std::getline(istr, line))
+        {
+            const char *first = line.data();
+            const char *last = first + line.size();
+            if (skip_spaces(first, last) == last)
+            {
+                continue;
+            }
+
+            int num = 0;
+            int den = 0;
+            const char *ptr = parse_int(first, last, num);
+            if (ptr != nullptr)
+            {
+                ptr = parse_int(ptr, last, den);
+            }
+            if (ptr == nullptr || den == 0 || skip_spaces(ptr, last) != last)
+            {
+                ++stats.errors;
+                continue;
+            }
+
+            // Reduced without throwing: e.g. 1/-2147483648 has no int form
+            int64_t wide_num = num;
+            int64_t wide_den = den;
+            if (wide_den < 0)
+            {
+                wide_num = -wide_num;
+                wide_den = -wide_den;
+            }
+            if (!reduce_to_int(wide_num, wide_den, num, den))
+            {
+                ++stats.errors;
+                continue;
+            }
+            out.push_back(Fraction::from_reduced(num, den));
+            ++stats.records;
+        }
+        return stats;
+    }
+
+    static bool is_digit(char chr)
+    {
+        return chr >= '0' && chr <= '9';
+    }
+
+    // value = value * 10^exp, false on int64 overflow
+    static bool mul_pow10(int64_t &value, int64_t exp)
+    {
+        for (; exp > 0; --exp)
+        {
+            if (__builtin_mul_overflow(value, 10, &value))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // value = value * 10 + digit, false on int64 overflow
+    static bool push_digit(int64_t &value, char digit)
+    {
+        return !__builtin_mul_overflow(value, 10, &value) &&
+               !__builtin_add_overflow(value, digit - '0', &value);
+    }
+
+    // Builds num/den * 10^exp10 as a reduced int fraction
+    static bool make_scaled(int64_t num, int64_t den, int64_t exp10, bool negative, Fraction &out)
+    {
+        if (num == 0)
+        {
+            out = Fraction();
+            return true;
+        }
+        int64_t gcd_ = std::gcd(num, den);
+        num /= gcd_;
+        den /= gcd_;
+
+        // Cancel factors of 2 and 5 before scaling so exact values are not lost to overflow
+        for (; exp10 > 0 && den % 10 == 0; --exp10)
+        {
+            den /= 10;
+        }
+        for (; exp10 < 0 && num % 10 == 0; ++exp10)
+        {
+            num /= 10;
+        }
+        if (!(exp10 >= 0 ? mul_pow10(num, exp10) : mul_pow10(den, -exp10)))
+        {
+            return false;
+        }
+        gcd_ = std::gcd(num, den);
+        num /= gcd_;
+        den /= gcd_;
+        if (num > INT_MAX || den > INT_MAX)
+        {
+            return false;
+        }
+        out = Fraction(negative ? -static_cast<int>(num) : static_cast<int>(num), static_cast<int>(den));
+        return true;
+    }
+
+    bool parse_decimal(std::string_view text, Fraction &out)
+    {
+        const char *ptr = text.data();
+        const char *last = ptr + text.size();
+        ptr = skip_spaces(ptr, last);
+
+        bool negative = false;
+        if (ptr != last && (*ptr == '+' || *ptr == '-'))
+        {
+            negative = (*ptr == '-');
+            ++ptr;
+        }
+
+        // Digits are accumulated with trailing zeros held back in `pending`,
+        // so "1500000e-6" does not overflow on its way to 3/2.
+        int64_t mantissa = 0;
+        int64_t pending = 0;
+        int64_t frac_digits = 0;
+        int digits = 0;
+        bool in_fraction = false;
+        for (; ptr != last; ++ptr)
+        {
+            if (is_digit(*ptr))
+            {
+                ++digits;
+                frac_digits += in_fraction ? 1 : 0;
+                if (*ptr == '0')
+                {
+                    ++pending;
+                    continue;
+                }
+                if (!mul_pow10(mantissa, pending) || !push_digit(mantissa, *ptr))
+                {
+                    return false;
+                }
+                pending = 0;
+            }
+            else if (*ptr == '.' && !in_fraction)
+            {
+                in_fraction = true;
+            }
+            else
+            {
+                break;
+            }
+        }
+        if (digits == 0)
+        {
+            return false;
+        }
+
+        // Optional repeating block: x = (IFR - IF) / (10^r - 1) * 10^-f
+        int64_t num = mantissa;
+        int64_t den = 1;
+        if (in_fraction && ptr != last && *ptr == '(')
+        {
+            if (!mul_pow10(mantissa, pending))
+            {
+                return false;
+            }
+            pending = 0;
+            int64_t repeated = mantissa;
+            int64_t nines = 0;
+            for (++ptr; ptr != last && is_digit(*ptr); ++ptr)
+            {
+                if (!push_digit(repeated, *ptr) || !push_digit(nines, '9'))
+                {
+                    return false;
+                }
+            }
+            if (nines == 0 || ptr == last || *ptr != ')')
+            {
+                return false;
+            }
+            ++ptr;
+            num = repeated - mantissa;
+            den = nines;
+        }
+
+        int64_t exp10 = 0;
+        if (ptr != last && (*ptr == 'e' || *ptr == 'E'))
+        {
+            ++ptr;
+            bool exp_negative = false;
+            if (ptr != last && (*ptr == '+' || *ptr == '-'))
+            {
+                exp_negative = (*ptr == '-');
+                ++ptr;
+            }
+            if (ptr == last || !is_digit(*ptr))
+            {
+                return false;
+            }
+            for (; ptr != last && is_digit(*ptr); ++ptr)
+            {
+                // Anything past this bound cannot fit in an int unless the value is zero
+                if (exp10 < 1000)
+                {
+                    exp10 = exp10 * 10 + (*ptr - '0');
+                }
+            }
+            exp10 = exp_negative ? -exp10 : exp10;
+        }
+
+        if (skip_spaces(ptr, last) != last)
+        {
+            return false;
+        }
+        return make_scaled(num, den, exp10 + pending - frac_digits, negative, out);
+    }
+
+    Fraction from_decimal(std::string_view text)
+    {
+        Fraction result;
+        if (!parse_decimal(text, result))
+        {
+            throw std::invalid_argument("Invalid or out of range decimal: " + std::string(text));
+        }
+        return result;
+    }
+
+    // Longest int rendering: sign and ten digits
+    constexpr std::size_t MAX_INT_CHARS = 11;
+
+    static char *write_int(char *ptr, int64_t value)
+    {
+        return std::to_chars(ptr, ptr + MAX_INT_CHARS + 1, value).ptr;
+    }
+
+    static char *write_ratio(char *ptr, int64_t num, int64_t den)
+    {
+        ptr = write_int(ptr, num);
+        *ptr++ = '/';
+        return write_int(ptr, den);
+    }
+
+    static char *write_mixed(char *ptr, int64_t num, int64_t den)
+    {
+        int64_t whole = num / den;
+        int64_t rest = num % den;
+        if (whole == 0 || rest == 0)
+        {
+            return rest == 0 ? write_int(ptr, whole) : write_ratio(ptr, rest, den);
+        }
+        ptr = write_int(ptr, whole);
+        *ptr++ = ' ';
+        return write_ratio(ptr, rest < 0 ? -rest : rest, den);
+    }
+
+    FractionWriter::FractionWriter(FractionFormat format, char separator, int digits)
+        : format(format), separator(separator), digits(digits < 0 ? 0 : digits) {}
+
+    void FractionWriter::append(const Fraction &fraction)
+    {
+        int64_t num = fraction.getNumerator();
+        int64_t den = fraction.getDenominator();
+        if (den < 0)
+        {
+            num = -num;
+            den = -den;
+        }
+
+        // Reserve the worst case, then trim back to what was actually written
+        std::size_t pos = buffer.size();
+        buffer.resize(pos + 1 + std::max(2 * MAX_INT_CHARS + 2, Fraction::decimal_buffer_size(digits)));
+        char *ptr = buffer.data() + pos;
+        if (!row_start)
+        {
+            *ptr++ = separator;
+        }
+        switch (format)
+        {
+        case FractionFormat::DECIMAL:
+            ptr += fraction.to_decimal(ptr, digits, RoundingMode::HALF_AWAY);
+            break;
+        case FractionFormat::MIXED:
+            ptr = write_mixed(ptr, num, den);
+            break;
+        default:
+            ptr = write_ratio(ptr, num, den);
+            break;
+        }
+        buffer.resize(static_cast<std::size_t>(ptr - buffer.data()));
+        row_start = false;
+    }
+
+    void FractionWriter::append(std::span<const Fraction> fractions)
+    {
+        for (const Fraction &fraction : fractions)
+        {
+            append(fraction);
+        }
+    }
+
+    void FractionWriter::end_row()
+    {
+        buffer.push_back('\n');
+        row_start = true;
+    }
+
+    void FractionWriter::flush(std::ostream &ostr)
+    {
+        ostr.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+
+    void FractionWriter::clear()
+    {
+        buffer.clear();
+        row_start = true;
+    }
+
+    std::string_view FractionWriter::view() const
+    {
+        return {buffer.data(), buffer.size()};
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "Fraction.hpp"
+
+namespace ariel
+{
+    // Counters reported by the batch reader
+    struct ReadStats
+    {
+        std::size_t records = 0; // fractions appended to the output
+        std::size_t errors = 0;  // malformed lines, zero denominators or values out of int range
+    };
+
+    // Reads one "numerator denominator" record per line and appends it to out, stopping
+    // after max_records (so a stream can be consumed in batches) or at end of input.
+    // Bad lines are counted and skipped without throwing; blank lines are ignored.
+    ReadStats read_fractions(std::istream &istr, std::vector<Fraction> &out, std::size_t max_records = SIZE_MAX);
+
+    // Exact parse of decimal, scientific and repeating-decimal notation,
+    // e.g. "-2.5", "1.25e-3", "0.1(6)". Only overflow-checked integer ops are used.
+    // Returns false (leaving out unchanged) on malformed text or if the value does not fit.
+    bool parse_decimal(std::string_view text, Fraction &out);
+
+    // Throwing counterpart of parse_decimal
+    Fraction from_decimal(std::string_view text);
+
+    // Output formats of FractionWriter
+    enum class FractionFormat
+    {
+        RATIO,   // "n/d"
+        DECIMAL, // fixed-point with a set number of digits, rounded half away from zero
+        MIXED    // "w n/d"
+    };
+
+    // Renders fractions into a reusable growable buffer and emits it with a
+    // single write call. Elements of a row are joined by the separator.
+    class FractionWriter
+    {
+    public:
+        explicit FractionWriter(FractionFormat format = FractionFormat::RATIO, char separator = ',', int digits = 6);
+
+        void append(const Fraction &fraction);
+        void append(std::span<const Fraction> fractions);
+        void end_row();
+
+        // Writes the buffered text and empties it; the capacity is kept for reuse
+        void flush(std::ostream &ostr);
+        void clear();
+        std::string_view view() const;
+
+    private:
+        std::vector<char> buffer;
+        FractionFormat format;
+        char separator;
+        int digits;
+        bool row_start = true;
+    };
+}
@@ -0,0 +1,407 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "Fraction.hpp"
+#include "FractionSort.hpp"
+
+namespace ariel
+{
+    // Ordered multimap Fraction -> V as a B+-tree with exact ordering. Every node keeps its
+    // numerators and denominators in two contiguous arrays, and in-node search counts
+    // smaller keys over the whole array with 64-bit cross products instead of branching
+    // per key. Leaves are linked both ways for range scans and nearest-value queries.
+    template <typename V>
+    class FractionIndex
+    {
+        static constexpr std::size_t LEAF_CAPACITY = 64;
+        static constexpr std::size_t INNER_CAPACITY = 63; // separators; one more child
+
+        struct Node
+        {
+            bool is_leaf;
+            std::size_t count = 0;
+        };
+
+        struct Leaf : Node
+        {
+            Leaf() : Node{true} {}
+            std::array<int, LEAF_CAPACITY> nums{};
+            std::array<int, LEAF_CAPACITY> dens{};
+            std::array<V, LEAF_CAPACITY> values{};
+            Leaf *prev = nullptr;
+            Leaf *next = nullptr;
+        };
+
+        // Separator i is the smallest key of child i + 1
+        struct Inner : Node
+        {
+            Inner() : Node{false} {}
+            std::array<int, INNER_CAPACITY> nums{};
+            std::array<int, INNER_CAPACITY> dens{};
+            std::array<Node *, INNER_CAPACITY + 1> children{};
+        };
+
+    public:
+        class const_iterator
+        {
+        public:
+            const_iterator() = default;
+            Fraction key() const { return Fraction::from_reduced(leaf->nums[pos], leaf->dens[pos]); }
+            const V &value() const { return leaf->values[pos]; }
+
+            const_iterator &operator++()
+            {
+                if (++pos == leaf->count && leaf->next != nullptr)
+                {
+                    leaf = leaf->next;
+                    pos = 0;
+                }
+                return *this;
+            }
+
+            bool operator==(const const_iterator &other) const = default;
+
+        private:
+            friend class FractionIndex;
+            const_iterator(const Leaf *leaf, std::size_t pos) : leaf(leaf), pos(pos) {}
+            const Leaf *leaf = nullptr;
+            std::size_t pos = 0;
+        };
+
+        FractionIndex() { clear(); }
+
+        std::size_t size() const { return total; }
+        bool empty() const { return total == 0; }
+
+        void clear()
+        {
+            leaves.clear();
+            inners.clear();
+            leaves.push_back(std::make_unique<Leaf>());
+            root = leaves.back().get();
+            first_leaf = leaves.back().get();
+            last_leaf = first_leaf;
+            total = 0;
+        }
+
+        const_iterator begin() const { return normalize(first_leaf, 0); }
+        const_iterator end() const { return {last_leaf, last_leaf->count}; }
+
+        // Replaces the contents with keys (ascending, duplicates allowed) and their values,
+        // packing leaves full and building the inner levels bottom-up
+        void bulk_load(std::span<const Fraction> keys, std::span<const V> values)
+        {
+            if (keys.size() != values.size())
+            {
+                throw std::invalid_argument("FractionIndex: keys and values differ in size");
+            }
+            for (std::size_t i = 1; i < keys.size(); ++i)
+            {
+                if (exact_less(keys[i], keys[i - 1]))
+                {
+                    throw std::invalid_argument("FractionIndex: bulk_load input is not sorted");
+                }
+            }
+            clear();
+            leaves.clear();
+            std::vector<Node *> level;
+            Leaf *prev = nullptr;
+            for (std::size_t first = 0; first < keys.size() || level.empty(); first += LEAF_CAPACITY)
+            {
+                leaves.push_back(std::make_unique<Leaf>());
+                Leaf *leaf = leaves.back().get();
+                std::size_t count = std::min(LEAF_CAPACITY, keys.size() - first);
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    leaf->nums[i] = keys[first + i].getNumerator();
+                    leaf->dens[i] = keys[first + i].getDenominator();
+                    leaf->values[i] = values[first + i];
+                }
+                leaf->count = count;
+                leaf->prev = prev;
+                if (prev != nullptr)
+                {
+                    prev->next = leaf;
+                }
+                prev = leaf;
+                level.push_back(leaf);
+            }
+            first_leaf = leaves.front().get();
+            last_leaf = prev;
+            total = keys.size();
+
+            while (level.size() > 1)
+            {
+                std::vector<Node *> parents;
+                for (std::size_t first = 0; first < level.size(); first += INNER_CAPACITY + 1)
+                {
+                    inners.push_back(std::make_unique<Inner>());
+                    Inner *inner = inners.back().get();
+                    std::size_t count = std::min(INNER_CAPACITY + 1, level.size() - first);
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        inner->children[i] = level[first + i];
+                        if (i > 0)
+                        {
+                            const Leaf *lowest = leftmost_leaf(level[first + i]);
+                            inner->nums[i - 1] = lowest->nums[0];
+                            inner->dens[i - 1] = lowest->dens[0];
+                        }
+                    }
+                    inner->count = count - 1;
+                    parents.push_back(inner);
+                }
+                level.swap(parents);
+            }
+            root = level.front();
+        }
+
+        // Inserts after any entries with an equal key
+        void insert(const Fraction &key, V value)
+        {
+            std::vector<std::pair<Inner *, std::size_t>> path;
+            Node *node = root;
+            while (!node->is_leaf)
+            {
+                auto *inner = static_cast<Inner *>(node);
+                std::size_t child = rank(inner->nums.data(), inner->dens.data(), inner->count, key, true);
+                path.emplace_back(inner, child);
+                node = inner->children[child];
+            }
+
+            auto *leaf = static_cast<Leaf *>(node);
+            std::size_t pos = rank(leaf->nums.data(), leaf->dens.data(), leaf->count, key, true);
+            if (leaf->count == LEAF_CAPACITY)
+            {
+                Leaf *right = split_leaf(leaf);
+                insert_separator(path, right);
+                if (pos > leaf->count)
+                {
+                    pos -= leaf->count;
+                    leaf = right;
+                }
+            }
+            for (std::size_t i = leaf->count; i > pos; --i)
+            {
+                leaf->nums[i] = leaf->nums[i - 1];
+                leaf->dens[i] = leaf->dens[i - 1];
+                leaf->values[i] = std::move(leaf->values[i - 1]);
+            }
+            leaf->nums[pos] = key.getNumerator();
+            leaf->dens[pos] = key.getDenominator();
+            leaf->values[pos] = std::move(value);
+            ++leaf->count;
+            ++total;
+        }
+
+        // First entry whose key is not less than key
+        const_iterator lower_bound(const Fraction &key) const
+        {
+            const Node *node = root;
+            while (!node->is_leaf)
+            {
+                const auto *inner = static_cast<const Inner *>(node);
+                node = inner->children[rank(inner->nums.data(), inner->dens.data(), inner->count, key, false)];
+            }
+            const auto *leaf = static_cast<const Leaf *>(node);
+            return normalize(leaf, rank(leaf->nums.data(), leaf->dens.data(), leaf->count, key, false));
+        }
+
+        // Calls func(key, value) for every entry with low <= key < high, in order
+        template <typename Func>
+        void range(const Fraction &low, const Fraction &high, Func &&func) const
+        {
+            for (const_iterator it = lower_bound(low), last = end(); it != last && exact_less(it.key(), high); ++it)
+            {
+                func(it.key(), it.value());
+            }
+        }
+
+        // Entry whose key is closest to target (the smaller key on a tie); end() if empty
+        const_iterator nearest(const Fraction &target) const
+        {
+            if (total == 0)
+            {
+                return end();
+            }
+            const_iterator above = lower_bound(target);
+            if (above == begin())
+            {
+                return above;
+            }
+            const_iterator below = predecessor(above);
+            if (above == end())
+            {
+                return below;
+            }
+            // |above - target| < |target - below| compared exactly in 128 bits
+            __int128 up_num = static_cast<__int128>(above.key().getNumerator()) * target.getDenominator() -
+                              static_cast<__int128>(target.getNumerator()) * above.key().getDenominator();
+            __int128 up_den = static_cast<__int128>(above.key().getDenominator()) * target.getDenominator();
+            __int128 down_num = static_cast<__int128>(target.getNumerator()) * below.key().getDenominator() -
+                                static_cast<__int128>(below.key().getNumerator()) * target.getDenominator();
+            __int128 down_den = static_cast<__int128>(below.key().getDenominator()) * target.getDenominator();
+            return up_num * down_den < down_num * up_den ? above : below;
+        }
+
+    private:
+        // Number of keys below key (inclusive: at or below). Denominators are positive.
+        static std::size_t rank(const int *nums, const int *dens, std::size_t count, const Fraction &key, bool inclusive)
+        {
+            const int64_t key_num = key.getNumerator();
+            const int64_t key_den = key.getDenominator();
+            std::size_t below = 0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                int64_t lhs = nums[i] * key_den;
+                int64_t rhs = key_num * dens[i];
+                below += static_cast<std::size_t>(inclusive ? lhs <= rhs : lhs < rhs);
+            }
+            return below;
+        }
+
+        static const Leaf *leftmost_leaf(const Node *node)
+        {
+            while (!node->is_leaf)
+            {
+                node = static_cast<const Inner *>(node)->children[0];
+            }
+            return static_cast<const Leaf *>(node);
+        }
+
+        // Positions one past a leaf's last entry move to the next leaf's first
+        static const_iterator normalize(const Leaf *leaf, std::size_t pos)
+        {
+            if (pos == leaf->count && leaf->next != nullptr)
+            {
+                return {leaf->next, 0};
+            }
+            return {leaf, pos};
+        }
+
+        static const_iterator predecessor(const_iterator it)
+        {
+            if (it.pos == 0)
+            {
+                return {it.leaf->prev, it.leaf->prev->count - 1};
+            }
+            return {it.leaf, it.pos - 1};
+        }
+
+        Leaf *split_leaf(Leaf *leaf)
+        {
+            leaves.push_back(std::make_unique<Leaf>());
+            Leaf *right = leaves.back().get();
+            std::size_t keep = leaf->count / 2;
+            for (std::size_t i = keep; i < leaf->count; ++i)
+            {
+                right->nums[i - keep] = leaf->nums[i];
+                right->dens[i - keep] = leaf->dens[i];
+                right->values[i - keep] = std::move(leaf->values[i]);
+            }
+            right->count = leaf->count - keep;
+            leaf->count = keep;
+            right->next = leaf->next;
+            right->prev = leaf;
+            if (leaf->next != nullptr)
+            {
+                leaf->next->prev = right;
+            }
+            else
+            {
+                last_leaf = right;
+            }
+            leaf->next = right;
+            return right;
+        }
+
+        // Hooks a new right sibling into the parents, splitting inner nodes and growing the root as needed
+        void insert_separator(std::vector<std::pair<Inner *, std::size_t>> &path, Node *right)
+        {
+            const Leaf *lowest = leftmost_leaf(right);
+            int sep_num = lowest->nums[0];
+            int sep_den = lowest->dens[0];
+            while (true)
+            {
+                if (path.empty())
+                {
+                    inners.push_back(std::make_unique<Inner>());
+                    Inner *new_root = inners.back().get();
+                    new_root->children[0] = root;
+                    new_root->children[1] = right;
+                    new_root->nums[0] = sep_num;
+                    new_root->dens[0] = sep_den;
+                    new_root->count = 1;
+                    root = new_root;
+                    return;
+                }
+                auto [parent, child] = path.back();
+                path.pop_back();
+
+                Inner *target = parent;
+                std::size_t pos = child;
+                Inner *split = nullptr;
+                int up_num = 0;
+                int up_den = 0;
+                if (parent->count == INNER_CAPACITY)
+                {
+                    // Move the upper half to a new node; the middle separator goes up a level
+                    inners.push_back(std::make_unique<Inner>());
+                    split = inners.back().get();
+                    std::size_t mid = parent->count / 2;
+                    up_num = parent->nums[mid];
+                    up_den = parent->dens[mid];
+                    for (std::size_t i = mid + 1; i < parent->count; ++i)
+                    {
+                        split->nums[i - mid - 1] = parent->nums[i];
+                        split->dens[i - mid - 1] = parent->dens[i];
+                    }
+                    for (std::size_t i = mid + 1; i <= parent->count; ++i)
+                    {
+                        split->children[i - mid - 1] = parent->children[i];
+                    }
+                    split->count = parent->count - mid - 1;
+                    parent->count = mid;
+                    if (child > mid)
+                    {
+                        target = split;
+                        pos = child - mid - 1;
+                    }
+                }
+
+                for (std::size_t i = target->count; i > pos; --i)
+                {
+                    target->nums[i] = target->nums[i - 1];
+                    target->dens[i] = target->dens[i - 1];
+                    target->children[i + 1] = target->children[i];
+                }
+                target->nums[pos] = sep_num;
+                target->dens[pos] = sep_den;
+                target->children[pos + 1] = right;
+                ++target->count;
+
+                if (split == nullptr)
+                {
+                    return;
+                }
+                right = split;
+                sep_num = up_num;
+                sep_den = up_den;
+            }
+        }
+
+        std::vector<std::unique_ptr<Leaf>> leaves;
+        std::vector<std::unique_ptr<Inner>> inners;
+        Node *root = nullptr;
+        Leaf *first_leaf = nullptr;
+        Leaf *last_leaf = nullptr;
+        std::size_t total = 0;
+    };
+}
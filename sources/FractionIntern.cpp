@@ -0,0 +1,70 @@
+#include "FractionIntern.hpp"
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+using namespace std;
+namespace ariel
+{
+    FractionInternTable::FractionInternTable(std::size_t capacity)
+        : slots(std::bit_ceil(capacity == 0 ? std::size_t{1} : capacity), Slot{0, 0}) {}
+
+    Fraction FractionInternTable::make(int numerator, int denominator)
+    {
+        if (denominator == 0)
+        {
+            throw std::invalid_argument("Denominator cannot be zero");
+        }
+        uint64_t raw = (static_cast<uint64_t>(static_cast<uint32_t>(numerator)) << 32U) | static_cast<uint32_t>(denominator);
+        Slot &slot = slots[static_cast<std::size_t>(hash_packed(raw)) & (slots.size() - 1)];
+        if (slot.raw == raw)
+        {
+            ++hit_count;
+            return unpack(slot.reduced);
+        }
+        ++miss_count;
+        Fraction fraction(numerator, denominator);
+        slot.raw = raw;
+        slot.reduced = pack(fraction);
+        return fraction;
+    }
+
+    uint64_t FractionInternTable::hits() const
+    {
+        return hit_count;
+    }
+
+    uint64_t FractionInternTable::misses() const
+    {
+        return miss_count;
+    }
+
+    double FractionInternTable::hit_rate() const
+    {
+        uint64_t total = hit_count + miss_count;
+        return total == 0 ? 0.0 : static_cast<double>(hit_count) / static_cast<double>(total);
+    }
+
+    void FractionInternTable::reset_stats()
+    {
+        hit_count = 0;
+        miss_count = 0;
+    }
+
+    void FractionInternTable::clear()
+    {
+        std::fill(slots.begin(), slots.end(), Slot{0, 0});
+        reset_stats();
+    }
+
+    std::size_t FractionInternTable::capacity() const
+    {
+        return slots.size();
+    }
+
+    FractionInternTable &thread_intern_table()
+    {
+        thread_local FractionInternTable table;
+        return table;
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Fraction.hpp"
+
+namespace ariel
+{
+    // Direct-mapped cache from raw (numerator, denominator) pairs to their reduced form.
+    // A hit returns the canonical fraction without running gcd; a miss reduces through
+    // the Fraction constructor and overwrites the slot.
+    class FractionInternTable
+    {
+    public:
+        explicit FractionInternTable(std::size_t capacity = DEFAULT_CAPACITY);
+
+        // Same contract as Fraction(numerator, denominator), including invalid_argument on zero
+        Fraction make(int numerator, int denominator);
+
+        uint64_t hits() const;
+        uint64_t misses() const;
+        double hit_rate() const;
+        void reset_stats();
+        void clear();
+        std::size_t capacity() const;
+
+        static constexpr std::size_t DEFAULT_CAPACITY = 4096;
+
+    private:
+        struct Slot
+        {
+            uint64_t raw;     // packed input pair; 0 (a zero denominator) marks an empty slot
+            uint64_t reduced; // packed canonical fraction
+        };
+
+        std::vector<Slot> slots;
+        uint64_t hit_count = 0;
+        uint64_t miss_count = 0;
+    };
+
+    // Per-thread default table, so hot loops can intern without sharing
+    FractionInternTable &thread_intern_table();
+
+    inline Fraction interned(int numerator, int denominator)
+    {
+        return thread_intern_table().make(numerator, denominator);
+    }
+}
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Fraction.hpp"
+
+namespace ariel
+{
+    // Flat open-addressing hash map keyed by Fraction. Keys are stored inline as packed
+    // 64-bit words in one array (linear probing, backward-shift erase, no tombstones);
+    // values sit in a parallel array so probing touches only the key words.
+    template <typename V>
+    class FractionMap
+    {
+    public:
+        FractionMap() = default;
+        explicit FractionMap(std::size_t expected) { reserve(expected); }
+
+        std::size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+
+        void clear()
+        {
+            keys.clear();
+            values.clear();
+            count = 0;
+        }
+
+        void reserve(std::size_t expected)
+        {
+            std::size_t capacity = MIN_CAPACITY;
+            while (capacity * MAX_LOAD_NUM < expected * MAX_LOAD_DEN)
+            {
+                capacity *= 2;
+            }
+            if (capacity > keys.size())
+            {
+                rehash(capacity);
+            }
+        }
+
+        V *find(const Fraction &key)
+        {
+            std::size_t slot = 0;
+            return locate(pack(key), slot) ? &values[slot] : nullptr;
+        }
+
+        const V *find(const Fraction &key) const
+        {
+            std::size_t slot = 0;
+            return locate(pack(key), slot) ? &values[slot] : nullptr;
+        }
+
+        bool contains(const Fraction &key) const
+        {
+            std::size_t slot = 0;
+            return locate(pack(key), slot);
+        }
+
+        // Inserts key with value if absent; returns false (and keeps the old value) otherwise
+        bool insert(const Fraction &key, V value)
+        {
+            return emplace_slot(pack(key), std::move(value)).second;
+        }
+
+        V &operator[](const Fraction &key)
+        {
+            return values[emplace_slot(pack(key), V()).first];
+        }
+
+        bool erase(const Fraction &key)
+        {
+            std::size_t slot = 0;
+            if (!locate(pack(key), slot))
+            {
+                return false;
+            }
+            // Backward-shift deletion keeps every probe chain contiguous
+            std::size_t mask = keys.size() - 1;
+            std::size_t hole = slot;
+            for (std::size_t next = (hole + 1) & mask; keys[next] != EMPTY; next = (next + 1) & mask)
+            {
+                std::size_t home = home_slot(keys[next]);
+                if (((next - home) & mask) >= ((next - hole) & mask))
+                {
+                    keys[hole] = keys[next];
+                    values[hole] = std::move(values[next]);
+                    hole = next;
+                }
+            }
+            keys[hole] = EMPTY;
+            values[hole] = V();
+            --count;
+            return true;
+        }
+
+        // Calls func(key, value) for every entry, in slot order
+        template <typename Func>
+        void for_each(Func &&func)
+        {
+            for (std::size_t slot = 0; slot < keys.size(); ++slot)
+            {
+                if (keys[slot] != EMPTY)
+                {
+                    func(unpack(keys[slot]), values[slot]);
+                }
+            }
+        }
+
+        template <typename Func>
+        void for_each(Func &&func) const
+        {
+            for (std::size_t slot = 0; slot < keys.size(); ++slot)
+            {
+                if (keys[slot] != EMPTY)
+                {
+                    func(unpack(keys[slot]), values[slot]);
+                }
+            }
+        }
+
+    private:
+        // A packed word with a zero denominator never encodes a valid fraction
+        static constexpr uint64_t EMPTY = 0;
+        static constexpr std::size_t MIN_CAPACITY = 16;
+        // Grow when size / capacity would exceed 3/4
+        static constexpr std::size_t MAX_LOAD_NUM = 3;
+        static constexpr std::size_t MAX_LOAD_DEN = 4;
+
+        std::size_t home_slot(uint64_t word) const
+        {
+            return static_cast<std::size_t>(hash_packed(word)) & (keys.size() - 1);
+        }
+
+        // Finds the key's slot, or the empty slot where it would be inserted
+        bool locate(uint64_t word, std::size_t &slot) const
+        {
+            if (keys.empty())
+            {
+                return false;
+            }
+            std::size_t mask = keys.size() - 1;
+            for (slot = home_slot(word); keys[slot] != EMPTY; slot = (slot + 1) & mask)
+            {
+                if (keys[slot] == word)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Grows only when a new key goes in, so updating a present key never moves values
+        std::pair<std::size_t, bool> emplace_slot(uint64_t word, V &&value)
+        {
+            std::size_t slot = 0;
+            if (locate(word, slot))
+            {
+                return {slot, false};
+            }
+            if ((count + 1) * MAX_LOAD_DEN > keys.size() * MAX_LOAD_NUM)
+            {
+                rehash(keys.empty() ? MIN_CAPACITY : keys.size() * 2);
+                locate(word, slot);
+            }
+            keys[slot] = word;
+            values[slot] = std::move(value);
+            ++count;
+            return {slot, true};
+        }
+
+        void rehash(std::size_t capacity)
+        {
+            std::vector<uint64_t> old_keys(capacity, EMPTY);
+            std::vector<V> old_values(capacity);
+            old_keys.swap(keys);
+            old_values.swap(values);
+            std::size_t mask = capacity - 1;
+            for (std::size_t i = 0; i < old_keys.size(); ++i)
+            {
+                if (old_keys[i] != EMPTY)
+                {
+                    std::size_t slot = home_slot(old_keys[i]);
+                    while (keys[slot] != EMPTY)
+                    {
+                        slot = (slot + 1) & mask;
+                    }
+                    keys[slot] = old_keys[i];
+                    values[slot] = std::move(old_values[i]);
+                }
+            }
+        }
+
+        std::vector<uint64_t> keys;
+        std::vector<V> values;
+        std::size_t count = 0;
+    };
+
+    // Flat open-addressing set of fractions, sharing FractionMap's layout
+    class FractionSet
+    {
+    public:
+        FractionSet() = default;
+        explicit FractionSet(std::size_t expected) : table(expected) {}
+
+        std::size_t size() const { return table.size(); }
+        bool empty() const { return table.empty(); }
+        void clear() { table.clear(); }
+        void reserve(std::size_t expected) { table.reserve(expected); }
+
+        bool insert(const Fraction &key) { return table.insert(key, Unit()); }
+        bool contains(const Fraction &key) const { return table.contains(key); }
+        bool erase(const Fraction &key) { return table.erase(key); }
+
+        template <typename Func>
+        void for_each(Func &&func) const
+        {
+            table.for_each([&func](const Fraction &key, Unit /*unused*/)
+                           { func(key); });
+        }
+
+    private:
+        struct Unit
+        {
+        };
+        FractionMap<Unit> table;
+    };
+}
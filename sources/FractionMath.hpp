@@ -0,0 +1,122 @@
+#pragma once
+
+#include <bit>
+#include <climits>
+#include <cstdint>
+
+#include "Fraction.hpp"
+#include "FractionReciprocal.hpp"
+
+namespace ariel
+{
+    // Binary (Stein) gcd: ctz and shifts instead of the division chain in Fraction::gcd
+    template <typename UInt>
+    inline UInt binary_gcd_t(UInt num_a, UInt num_b)
+    {
+        if (num_a == 0)
+        {
+            return num_b;
+        }
+        if (num_b == 0)
+        {
+            return num_a;
+        }
+        int shift = std::countr_zero(num_a | num_b);
+        num_a >>= std::countr_zero(num_a);
+        do
+        {
+            // min/max instead of a swap branch compiles to conditional moves
+            num_b >>= std::countr_zero(num_b);
+            UInt low = num_a < num_b ? num_a : num_b;
+            UInt high = num_a < num_b ? num_b : num_a;
+            num_a = low;
+            num_b = high - low;
+        } while (num_b != 0);
+        return static_cast<UInt>(num_a << shift);
+    }
+
+    // Runs on 32-bit words when both operands fit, which is the common case
+    inline uint64_t binary_gcd(uint64_t num_a, uint64_t num_b)
+    {
+        if (((num_a | num_b) >> 32U) == 0)
+        {
+            return binary_gcd_t(static_cast<uint32_t>(num_a), static_cast<uint32_t>(num_b));
+        }
+        return binary_gcd_t(num_a, num_b);
+    }
+
+    inline uint64_t magnitude(int64_t value)
+    {
+        return value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    }
+
+    // Reduces num/den (den > 0) in place; false if the reduced terms do not fit in int
+    inline bool reduce_to_int(int64_t num, int64_t den, int &out_num, int &out_den)
+    {
+        const uint64_t mag = magnitude(num);
+        const uint64_t gcd_ = binary_gcd(mag, static_cast<uint64_t>(den));
+        // Coprime terms, the most common case, need no division at all; small ones go
+        // through the calling thread's reciprocal table
+        if (gcd_ != 1 && ((mag | static_cast<uint64_t>(den)) >> 32U) == 0)
+        {
+            const uint32_t quotient = divide_small(static_cast<uint32_t>(mag), static_cast<uint32_t>(gcd_));
+            num = num < 0 ? -static_cast<int64_t>(quotient) : quotient;
+            den = divide_small(static_cast<uint32_t>(den), static_cast<uint32_t>(gcd_));
+        }
+        else if (gcd_ != 1)
+        {
+            num /= static_cast<int64_t>(gcd_);
+            den /= static_cast<int64_t>(gcd_);
+        }
+        if (num > INT_MAX || num < -INT_MAX || den > INT_MAX)
+        {
+            return false;
+        }
+        out_num = static_cast<int>(num);
+        out_den = static_cast<int>(den);
+        return true;
+    }
+
+    // Exact sum reduced before the range check, so 1/2 + 1/2 never trips on an unreduced
+    // intermediate; false if the reduced result does not fit in int
+    inline bool checked_add(const Fraction &lhs, const Fraction &rhs, Fraction &out)
+    {
+        int64_t lhs_den = lhs.getDenominator();
+        int64_t rhs_den = rhs.getDenominator();
+        int64_t num = lhs.getNumerator() * rhs_den + rhs.getNumerator() * lhs_den;
+        int64_t den = lhs_den * rhs_den;
+        if (den < 0)
+        {
+            num = -num;
+            den = -den;
+        }
+        int out_num = 0;
+        int out_den = 1;
+        if (!reduce_to_int(num, den, out_num, out_den))
+        {
+            return false;
+        }
+        out = Fraction::from_reduced(out_num, out_den);
+        return true;
+    }
+
+    // Exact product reduced before the range check; false if it does not fit in int
+    inline bool checked_mul(const Fraction &lhs, const Fraction &rhs, Fraction &out)
+    {
+        int64_t num = static_cast<int64_t>(lhs.getNumerator()) * rhs.getNumerator();
+        int64_t den = static_cast<int64_t>(lhs.getDenominator()) * rhs.getDenominator();
+        if (den < 0)
+        {
+            num = -num;
+            den = -den;
+        }
+        int out_num = 0;
+        int out_den = 1;
+        if (!reduce_to_int(num, den, out_num, out_den))
+        {
+            return false;
+        }
+        out = Fraction::from_reduced(out_num, out_den);
+        return true;
+    }
+}
@@ -0,0 +1,348 @@
+#include "FractionParallel.hpp"
+#include "FractionMath.hpp"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std;
+namespace ariel
+{
+    // Leaf size of the reduction tree and the scans; fixed so the tree shape does not
+    // depend on threads
+    constexpr std::size_t SUM_BLOCK = PARALLEL_BLOCK;
+
+    static unsigned worker_count(unsigned threads, std::size_t tasks)
+    {
+        if (threads == 0)
+        {
+            threads = std::max(1U, std::thread::hardware_concurrency());
+        }
+        return static_cast<unsigned>(std::min<std::size_t>(threads, std::max<std::size_t>(tasks, 1)));
+    }
+
+    // Runs task(i) for i in [0, tasks) on the given number of threads, handing out indices
+    // through a shared counter. Rethrows the exception of the lowest failing index.
+    template <typename Task>
+    static void run_blocks(std::size_t tasks, unsigned threads, Task task)
+    {
+        std::vector<std::exception_ptr> errors(tasks);
+        std::atomic<std::size_t> next{0};
+        auto worker = [&]
+        {
+            for (std::size_t i = next++; i < tasks; i = next++)
+            {
+                try
+                {
+                    task(i);
+                }
+                catch (...)
+                {
+                    errors[i] = std::current_exception();
+                }
+            }
+        };
+        std::vector<std::thread> pool;
+        for (unsigned i = 1; i < threads; ++i)
+        {
+            pool.emplace_back(worker);
+        }
+        worker();
+        for (std::thread &thread : pool)
+        {
+            thread.join();
+        }
+        for (const std::exception_ptr &error : errors)
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    // run_blocks through a caller-supplied scheduler, with the same exception contract
+    template <typename Task>
+    static void run_scheduled(std::size_t tasks, const BlockScheduler &scheduler, Task task)
+    {
+        std::vector<std::exception_ptr> errors(tasks);
+        scheduler(tasks, [&](std::size_t i)
+                  {
+            try
+            {
+                task(i);
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            } });
+        for (const std::exception_ptr &error : errors)
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    // Runners for the algorithm templates below: run(tasks, task)
+    static auto thread_runner(unsigned threads)
+    {
+        return [threads](std::size_t tasks, auto task)
+        { run_blocks(tasks, worker_count(threads, tasks), task); };
+    }
+
+    static auto scheduled_runner(const BlockScheduler &scheduler)
+    {
+        return [&scheduler](std::size_t tasks, auto task)
+        { run_scheduled(tasks, scheduler, task); };
+    }
+
+    // Sums values in place by combining neighbours level by level: (a+b)+(c+d)...
+    static Fraction pairwise_sum(std::vector<Fraction> &values)
+    {
+        if (values.empty())
+        {
+            return Fraction();
+        }
+        for (std::size_t width = 1; width < values.size(); width *= 2)
+        {
+            for (std::size_t i = 0; i + width < values.size(); i += 2 * width)
+            {
+                if (!checked_add(values[i], values[i + width], values[i]))
+                {
+                    throw std::overflow_error("Overflow in parallel_sum");
+                }
+            }
+        }
+        return values[0];
+    }
+
+    template <typename Run>
+    static Fraction sum(std::span<const Fraction> fractions, Run run)
+    {
+        const std::size_t blocks = (fractions.size() + SUM_BLOCK - 1) / SUM_BLOCK;
+        std::vector<Fraction> partial(blocks);
+        run(blocks, [&](std::size_t block)
+                   {
+            std::span<const Fraction> part = fractions.subspan(block * SUM_BLOCK, std::min(SUM_BLOCK, fractions.size() - block * SUM_BLOCK));
+            std::vector<Fraction> values(part.begin(), part.end());
+            partial[block] = pairwise_sum(values); });
+        return pairwise_sum(partial);
+    }
+
+    Fraction parallel_sum(std::span<const Fraction> fractions, unsigned threads)
+    {
+        return sum(fractions, thread_runner(threads));
+    }
+
+    Fraction parallel_sum(std::span<const Fraction> fractions, const BlockScheduler &scheduler)
+    {
+        return sum(fractions, scheduled_runner(scheduler));
+    }
+
+    // Reduced fraction with 64-bit terms (den > 0), the running total of the scans
+    struct WideSum
+    {
+        int64_t num = 0;
+        int64_t den = 1;
+    };
+
+    // Knuth's addition of reduced fractions: with g = gcd(a.den, b.den), only gcd(t, g)
+    // can divide the cross sum t, so the result is reduced with one 64-bit gcd of t mod g.
+    // False if the reduced result does not fit in 64-bit terms.
+    static bool add_wide(const WideSum &lhs, int64_t num, int64_t den, WideSum &out)
+    {
+        auto gcd_ = static_cast<int64_t>(binary_gcd(static_cast<uint64_t>(lhs.den), static_cast<uint64_t>(den)));
+        const int64_t lhs_scale = den / gcd_;
+        const int64_t rhs_scale = lhs.den / gcd_;
+        const __int128 cross = static_cast<__int128>(lhs.num) * lhs_scale + static_cast<__int128>(num) * rhs_scale;
+        // Usually the cross sum fits in 64 bits, and 128-bit division is a library call
+        __int128 out_num = cross;
+        int64_t common = 1;
+        if (cross >= INT64_MIN && cross <= INT64_MAX)
+        {
+            const auto narrow = static_cast<int64_t>(cross);
+            common = gcd_ == 1 ? 1 : static_cast<int64_t>(binary_gcd(magnitude(narrow % gcd_), static_cast<uint64_t>(gcd_)));
+            out_num = narrow / common;
+        }
+        else if (gcd_ != 1)
+        {
+            common = static_cast<int64_t>(binary_gcd(magnitude(static_cast<int64_t>(cross % gcd_)), static_cast<uint64_t>(gcd_)));
+            out_num = cross / common;
+        }
+        const __int128 out_den = static_cast<__int128>(rhs_scale) * (den / common);
+        if (out_num > INT64_MAX || out_num < -INT64_MAX || out_den > INT64_MAX)
+        {
+            return false;
+        }
+        out.num = static_cast<int64_t>(out_num);
+        out.den = static_cast<int64_t>(out_den);
+        return true;
+    }
+
+    static bool add_wide(const WideSum &lhs, const WideSum &rhs, WideSum &out)
+    {
+        return add_wide(lhs, rhs.num, rhs.den, out);
+    }
+
+    static bool add_wide(const WideSum &lhs, const Fraction &rhs, WideSum &out)
+    {
+        int64_t num = rhs.getNumerator();
+        int64_t den = rhs.getDenominator();
+        if (den < 0)
+        {
+            num = -num;
+            den = -den;
+        }
+        return add_wide(lhs, num, den, out);
+    }
+
+    template <bool Inclusive, typename Run>
+    static std::size_t scan(std::span<const Fraction> in, std::span<Fraction> out, StatusBitmap &status, Run run)
+    {
+        if (out.size() < in.size())
+        {
+            throw std::invalid_argument("Scan output is shorter than its input");
+        }
+        status.resize(in.size());
+        const std::size_t blocks = (in.size() + SUM_BLOCK - 1) / SUM_BLOCK;
+
+        // Pass 1: block totals (valid = false if a total local to the block overflowed,
+        // which says nothing about the running total, so the block is redone serially)
+        std::vector<WideSum> totals(blocks);
+        std::vector<char> valid(blocks, 1);
+        run(blocks, [&](std::size_t block)
+                   {
+            const std::size_t last = std::min(in.size(), (block + 1) * SUM_BLOCK);
+            WideSum total;
+            for (std::size_t i = block * SUM_BLOCK; i < last; ++i)
+            {
+                if (!add_wide(total, in[i], total))
+                {
+                    valid[block] = 0;
+                    return;
+                }
+            }
+            totals[block] = total; });
+
+        // Exact scan of the block totals into block offsets, up to the first block in which
+        // the running total itself overflows 64 bits
+        std::vector<WideSum> offsets(blocks);
+        std::size_t first_invalid = blocks;
+        WideSum running;
+        for (std::size_t block = 0; block < blocks && first_invalid == blocks; ++block)
+        {
+            offsets[block] = running;
+            if (valid[block] != 0)
+            {
+                if (!add_wide(running, totals[block], running))
+                {
+                    first_invalid = block;
+                }
+                continue;
+            }
+            const std::size_t last = std::min(in.size(), (block + 1) * SUM_BLOCK);
+            for (std::size_t i = block * SUM_BLOCK; i < last; ++i)
+            {
+                if (!add_wide(running, in[i], running))
+                {
+                    first_invalid = block;
+                    break;
+                }
+            }
+        }
+
+        // Pass 2: every block rescans from its offset. Blocks are a multiple of 32 elements,
+        // so each one owns whole status words and the threads never share one.
+        static_assert(SUM_BLOCK % StatusBitmap::PER_WORD == 0);
+        std::vector<std::size_t> failed(blocks, 0);
+        // Per block, the element whose running total first overflows 64 bits, or in.size()
+        std::vector<std::size_t> wrap(blocks, in.size());
+        auto poison = [&](std::size_t i, std::size_t block)
+        {
+            out[i] = Fraction();
+            status.set(i, FractionStatus::OVERFLOWED);
+            ++failed[block];
+        };
+        run(blocks, [&](std::size_t block)
+                   {
+            const std::size_t first = block * SUM_BLOCK;
+            const std::size_t last = std::min(in.size(), first + SUM_BLOCK);
+            WideSum total = offsets[block];
+            bool wrapped = block > first_invalid;
+            for (std::size_t i = first; i < last; ++i)
+            {
+                // Read before writing: out may alias in
+                const Fraction value = in[i];
+                WideSum next = total;
+                const bool next_wrapped = wrapped || !add_wide(total, value, next);
+                if (next_wrapped && !wrapped)
+                {
+                    wrap[block] = i;
+                }
+                const WideSum &shown = Inclusive ? next : total;
+                if ((Inclusive ? next_wrapped : wrapped) || shown.num > INT_MAX || shown.num < -INT_MAX || shown.den > INT_MAX)
+                {
+                    poison(i, block);
+                }
+                else
+                {
+                    out[i] = Fraction::from_reduced(static_cast<int>(shown.num), static_cast<int>(shown.den));
+                }
+                total = next;
+                wrapped = next_wrapped;
+            } });
+
+        // A block with a valid offset can still overflow inside and recover by its end;
+        // everything after the first such element is failed, wherever the blocks fall
+        std::size_t first_wrap = in.size();
+        for (std::size_t index : wrap)
+        {
+            first_wrap = std::min(first_wrap, index);
+        }
+        if (first_wrap < in.size())
+        {
+            run(blocks, [&](std::size_t block)
+                       {
+                const std::size_t last = std::min(in.size(), (block + 1) * SUM_BLOCK);
+                for (std::size_t i = std::max(block * SUM_BLOCK, first_wrap + 1); i < last; ++i)
+                {
+                    if (status[i] == FractionStatus::OK)
+                    {
+                        poison(i, block);
+                    }
+                } });
+        }
+        std::size_t result = 0;
+        for (std::size_t count : failed)
+        {
+            result += count;
+        }
+        return result;
+    }
+
+    std::size_t parallel_inclusive_scan(std::span<const Fraction> in, std::span<Fraction> out, StatusBitmap &status, unsigned threads)
+    {
+        return scan<true>(in, out, status, thread_runner(threads));
+    }
+
+    std::size_t parallel_exclusive_scan(std::span<const Fraction> in, std::span<Fraction> out, StatusBitmap &status, unsigned threads)
+    {
+        return scan<false>(in, out, status, thread_runner(threads));
+    }
+
+    std::size_t parallel_inclusive_scan(std::span<const Fraction> in, std::span<Fraction> out, StatusBitmap &status, const BlockScheduler &scheduler)
+    {
+        return scan<true>(in, out, status, scheduled_runner(scheduler));
+    }
+
+    std::size_t parallel_exclusive_scan(std::span<const Fraction> in, std::span<Fraction> out, StatusBitmap &status, const BlockScheduler &scheduler)
+    {
+        return scan<false>(in, out, status, scheduled_runner(scheduler));
+    }
+}
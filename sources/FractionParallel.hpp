@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <span>
+
+#include "Fraction.hpp"
+#include "FractionBatch.hpp"
+
+namespace ariel
+{
+    // Elements per block of the algorithms below; blocks are the unit of scheduling
+    constexpr std::size_t PARALLEL_BLOCK = 4096;
+
+    // Runs task(i) for every block index i in [0, tasks) and returns when all are done.
+    // The overloads taking one let the caller decide which thread runs which block (see
+    // NumaFractionArray::scheduler); results are the same as with a thread count.
+    using BlockScheduler = std::function<void(std::size_t tasks, const std::function<void(std::size_t)> &task)>;
+
+    // Exact sum as a balanced pairwise tree: fixed-size blocks are summed by halving and the
+    // block sums are combined the same way, so intermediate denominators grow like log(n)
+    // instead of n. Blocks are shared out to `threads` workers (0: hardware concurrency),
+    // but the tree depends only on the input size, so results and overflow behavior are
+    // identical for any thread count. Throws std::overflow_error if a partial sum does not fit.
+    Fraction parallel_sum(std::span<const Fraction> fractions, unsigned threads = 0);
+    Fraction parallel_sum(std::span<const Fraction> fractions, const BlockScheduler &scheduler);
+
+    // Running totals: out[i] = in[0] + ... + in[i] (inclusive) or in[0] + ... + in[i-1]
+    // (exclusive, out[0] = 0). Two passes over fixed-size blocks: each block's total is
+    // computed in parallel, the totals are scanned serially into block offsets, then every
+    // block rescans from its offset in parallel. Running totals are exact 64-bit fractions;
+    // an element whose total does not fit in a Fraction is written as 0/1 and marked
+    // OVERFLOWED in status, and once the running total overflows 64 bits, every later
+    // element is too. A block whose own total overflows is carried serially instead, so the
+    // failed elements are those of a serial scan and do not depend on blocks or threads.
+    // out may alias in. Returns the number of OVERFLOWED elements; std::invalid_argument if
+    // out is shorter than in.
+    std::size_t parallel_inclusive_scan(std::span<const Fraction> in, std::span<Fraction> out, StatusBitmap &status, unsigned threads = 0);
+    std::size_t parallel_exclusive_scan(std::span<const Fraction> in, std::span<Fraction> out, StatusBitmap &status, unsigned threads = 0);
+    std::size_t parallel_inclusive_scan(std::span<const Fraction> in, std::span<Fraction> out, StatusBitmap &status, const BlockScheduler &scheduler);
+    std::size_t parallel_exclusive_scan(std::span<const Fraction> in, std::span<Fraction> out, StatusBitmap &status, const BlockScheduler &scheduler);
+}
@@ -0,0 +1,420 @@
+#include "FractionPipeline.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <latch>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std;
+namespace ariel
+{
+    using Clock = std::chrono::steady_clock;
+    using Batch = std::vector<Fraction>;
+
+    static double seconds_since(Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // One thread resuming the coroutine handles posted to it, in order
+    class StageExecutor
+    {
+    public:
+        StageExecutor() : thread([this]
+                                 { loop(); }) {}
+        ~StageExecutor()
+        {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                stopping = true;
+            }
+            wake.notify_one();
+            thread.join();
+        }
+
+        StageExecutor(const StageExecutor &) = delete;
+        StageExecutor &operator=(const StageExecutor &) = delete;
+
+        void post(std::coroutine_handle<> handle)
+        {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                ready.push_back(handle);
+            }
+            wake.notify_one();
+        }
+
+        // The executor whose thread is running the caller, if any
+        static StageExecutor *current() { return running; }
+
+    private:
+        void loop()
+        {
+            running = this;
+            while (true)
+            {
+                std::coroutine_handle<> handle;
+                {
+                    std::unique_lock<std::mutex> guard(lock);
+                    wake.wait(guard, [this]
+                              { return stopping || !ready.empty(); });
+                    if (ready.empty())
+                    {
+                        return;
+                    }
+                    handle = ready.front();
+                    ready.pop_front();
+                }
+                handle.resume();
+            }
+        }
+
+        static inline thread_local StageExecutor *running = nullptr;
+
+        std::mutex lock;
+        std::condition_variable wake;
+        std::deque<std::coroutine_handle<>> ready;
+        bool stopping = false;
+        std::thread thread;
+    };
+
+    // Bounded single-producer single-consumer queue between two stages. push and pop are
+    // awaitables: instead of blocking, the caller's coroutine is parked and later posted
+    // back to its own executor by the other side. Closing wakes both sides; a closed
+    // channel rejects pushes and drains what it holds before pop yields nullopt.
+    class Channel
+    {
+    public:
+        explicit Channel(std::size_t capacity) : capacity(std::max<std::size_t>(capacity, 1)) {}
+
+        class PushAwaiter
+        {
+        public:
+            PushAwaiter(Channel &channel, Batch value, StageCounters &counters)
+                : channel(channel), value(std::move(value)), counters(counters) {}
+
+            bool await_ready() const noexcept { return false; }
+            bool await_suspend(std::coroutine_handle<> handle)
+            {
+                std::unique_lock<std::mutex> guard(channel.lock);
+                if (channel.closed)
+                {
+                    return false;
+                }
+                if (channel.items.size() < channel.capacity)
+                {
+                    accepted = true;
+                    channel.deliver(std::move(value), guard);
+                    return false;
+                }
+                // Full: the consumer moves our value in when it frees a slot
+                since = Clock::now();
+                suspended = true;
+                channel.writer = this;
+                channel.writer_handle = handle;
+                channel.writer_executor = StageExecutor::current();
+                return true;
+            }
+            bool await_resume()
+            {
+                if (suspended)
+                {
+                    counters.blocked_seconds += seconds_since(since);
+                }
+                return accepted;
+            }
+
+        private:
+            friend class Channel;
+            Channel &channel;
+            Batch value;
+            StageCounters &counters;
+            Clock::time_point since;
+            bool suspended = false;
+            bool accepted = false;
+        };
+
+        class PopAwaiter
+        {
+        public:
+            PopAwaiter(Channel &channel, StageCounters &counters) : channel(channel), counters(counters) {}
+
+            bool await_ready() const noexcept { return false; }
+            bool await_suspend(std::coroutine_handle<> handle)
+            {
+                std::unique_lock<std::mutex> guard(channel.lock);
+                if (!channel.items.empty())
+                {
+                    result = std::move(channel.items.front());
+                    channel.items.pop_front();
+                    channel.refill(guard);
+                    return false;
+                }
+                if (channel.closed)
+                {
+                    return false;
+                }
+                // Empty: the producer hands its next batch straight to us
+                since = Clock::now();
+                suspended = true;
+                channel.reader = this;
+                channel.reader_handle = handle;
+                channel.reader_executor = StageExecutor::current();
+                return true;
+            }
+            std::optional<Batch> await_resume()
+            {
+                if (suspended)
+                {
+                    counters.blocked_seconds += seconds_since(since);
+                }
+                return std::move(result);
+            }
+
+        private:
+            friend class Channel;
+            Channel &channel;
+            StageCounters &counters;
+            std::optional<Batch> result;
+            Clock::time_point since;
+            bool suspended = false;
+        };
+
+        PushAwaiter push(Batch value, StageCounters &counters) { return PushAwaiter(*this, std::move(value), counters); }
+        PopAwaiter pop(StageCounters &counters) { return PopAwaiter(*this, counters); }
+
+        void close()
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            if (closed)
+            {
+                return;
+            }
+            closed = true;
+            std::coroutine_handle<> waiting_reader = std::exchange(reader_handle, nullptr);
+            StageExecutor *to_reader = reader_executor;
+            reader = nullptr;
+            std::coroutine_handle<> waiting_writer = std::exchange(writer_handle, nullptr);
+            StageExecutor *to_writer = writer_executor;
+            writer = nullptr;
+            guard.unlock();
+            if (waiting_reader)
+            {
+                to_reader->post(waiting_reader);
+            }
+            if (waiting_writer)
+            {
+                to_writer->post(waiting_writer);
+            }
+        }
+
+    private:
+        // Called with the lock held and room in the queue
+        void deliver(Batch value, std::unique_lock<std::mutex> &guard)
+        {
+            if (reader == nullptr)
+            {
+                items.push_back(std::move(value));
+                return;
+            }
+            reader->result = std::move(value);
+            reader = nullptr;
+            std::coroutine_handle<> handle = std::exchange(reader_handle, nullptr);
+            guard.unlock();
+            reader_executor->post(handle);
+        }
+
+        // Called with the lock held after a pop: admits a parked writer's batch
+        void refill(std::unique_lock<std::mutex> &guard)
+        {
+            if (writer == nullptr)
+            {
+                return;
+            }
+            items.push_back(std::move(writer->value));
+            writer->accepted = true;
+            writer = nullptr;
+            std::coroutine_handle<> handle = std::exchange(writer_handle, nullptr);
+            guard.unlock();
+            writer_executor->post(handle);
+        }
+
+        std::mutex lock;
+        std::deque<Batch> items;
+        std::size_t capacity;
+        bool closed = false;
+        PopAwaiter *reader = nullptr;
+        std::coroutine_handle<> reader_handle;
+        StageExecutor *reader_executor = nullptr;
+        PushAwaiter *writer = nullptr;
+        std::coroutine_handle<> writer_handle;
+        StageExecutor *writer_executor = nullptr;
+    };
+
+    // Coroutine of one stage. Starts suspended; start() posts it to its executor, and the
+    // latch is counted down once it has finished and can be destroyed.
+    class StageTask
+    {
+    public:
+        struct promise_type
+        {
+            std::latch *done = nullptr;
+            std::exception_ptr error;
+
+            StageTask get_return_object() { return StageTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            auto final_suspend() noexcept
+            {
+                struct Finished
+                {
+                    bool await_ready() noexcept { return false; }
+                    void await_suspend(std::coroutine_handle<promise_type> handle) noexcept { handle.promise().done->count_down(); }
+                    void await_resume() noexcept {}
+                };
+                return Finished{};
+            }
+            void return_void() {}
+            void unhandled_exception() { error = std::current_exception(); }
+        };
+
+        explicit StageTask(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+        StageTask(StageTask &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+        StageTask(const StageTask &) = delete;
+        StageTask &operator=(const StageTask &) = delete;
+        StageTask &operator=(StageTask &&) = delete;
+        ~StageTask()
+        {
+            if (handle)
+            {
+                handle.destroy();
+            }
+        }
+
+        void start(StageExecutor &executor, std::latch &done)
+        {
+            handle.promise().done = &done;
+            executor.post(handle);
+        }
+        std::exception_ptr error() const { return handle.promise().error; }
+
+    private:
+        std::coroutine_handle<promise_type> handle;
+    };
+
+    // Closes a stage's channels however it ends, so a failure cancels its neighbours
+    struct CloseOnExit
+    {
+        Channel *input;
+        Channel *output;
+        ~CloseOnExit()
+        {
+            if (input != nullptr)
+            {
+                input->close();
+            }
+            if (output != nullptr)
+            {
+                output->close();
+            }
+        }
+    };
+
+    static StageTask parse_stage(std::istream &istr, Channel &output, std::size_t batch_size,
+                                 StageCounters &counters, std::size_t &errors)
+    {
+        CloseOnExit closer{nullptr, &output};
+        while (true)
+        {
+            Clock::time_point start = Clock::now();
+            Batch batch;
+            batch.reserve(batch_size);
+            errors += read_fractions(istr, batch, batch_size).errors;
+            counters.busy_seconds += seconds_since(start);
+            if (batch.empty())
+            {
+                co_return;
+            }
+            ++counters.batches;
+            counters.records += batch.size();
+            if (!co_await output.push(std::move(batch), counters))
+            {
+                co_return;
+            }
+        }
+    }
+
+    static StageTask compute_stage(Channel &input, Channel &output,
+                                   const std::function<void(std::span<Fraction>)> &compute, StageCounters &counters)
+    {
+        CloseOnExit closer{&input, &output};
+        while (std::optional<Batch> batch = co_await input.pop(counters))
+        {
+            Clock::time_point start = Clock::now();
+            compute(*batch);
+            counters.busy_seconds += seconds_since(start);
+            ++counters.batches;
+            counters.records += batch->size();
+            if (!co_await output.push(std::move(*batch), counters))
+            {
+                co_return;
+            }
+        }
+    }
+
+    static StageTask format_stage(Channel &input, std::ostream &ostr, const PipelineOptions &options, StageCounters &counters)
+    {
+        CloseOnExit closer{&input, nullptr};
+        FractionWriter writer(options.format, ',', options.digits);
+        while (std::optional<Batch> batch = co_await input.pop(counters))
+        {
+            Clock::time_point start = Clock::now();
+            for (const Fraction &fraction : *batch)
+            {
+                writer.append(fraction);
+                writer.end_row();
+            }
+            writer.flush(ostr);
+            counters.busy_seconds += seconds_since(start);
+            ++counters.batches;
+            counters.records += batch->size();
+        }
+    }
+
+    PipelineStats run_pipeline(std::istream &istr, std::ostream &ostr,
+                               const std::function<void(std::span<Fraction>)> &compute,
+                               const PipelineOptions &options)
+    {
+        PipelineStats stats;
+        Channel parsed(options.queue_depth);
+        Channel computed(options.queue_depth);
+        std::latch done(3);
+        {
+            // Executors are declared first so they outlive the coroutine frames
+            StageExecutor executors[3];
+            std::vector<StageTask> stages;
+            stages.push_back(parse_stage(istr, parsed, std::max<std::size_t>(options.batch_size, 1), stats.parse, stats.parse_errors));
+            stages.push_back(compute_stage(parsed, computed, compute, stats.compute));
+            stages.push_back(format_stage(computed, ostr, options, stats.format));
+            for (std::size_t i = 0; i < stages.size(); ++i)
+            {
+                stages[i].start(executors[i], done);
+            }
+            done.wait();
+            for (const StageTask &stage : stages)
+            {
+                if (stage.error())
+                {
+                    std::rethrow_exception(stage.error());
+                }
+            }
+        }
+        return stats;
+    }
+}
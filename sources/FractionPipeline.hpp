@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <span>
+
+#include "Fraction.hpp"
+#include "FractionIO.hpp"
+
+namespace ariel
+{
+    struct PipelineOptions
+    {
+        std::size_t batch_size = 1024; // records per batch handed between stages
+        std::size_t queue_depth = 4;   // batches buffered between two stages
+        FractionFormat format = FractionFormat::RATIO;
+        int digits = 6; // for FractionFormat::DECIMAL
+    };
+
+    struct StageCounters
+    {
+        std::uint64_t batches = 0;
+        std::uint64_t records = 0;
+        double busy_seconds = 0;    // in the stage's own work
+        double blocked_seconds = 0; // suspended on an empty input or a full output queue
+    };
+
+    struct PipelineStats
+    {
+        StageCounters parse;
+        StageCounters compute;
+        StageCounters format;
+        std::size_t parse_errors = 0; // malformed lines skipped by the parser
+    };
+
+    // Streams "numerator denominator" records from istr through compute and writes one
+    // formatted fraction per line to ostr. The parse, compute and format stages are C++20
+    // coroutines, each resumed only on its own thread, connected by queues of at most
+    // queue_depth batches: a stage that gets ahead suspends (without blocking its thread)
+    // until the next one catches up, so memory stays bounded whatever the input size.
+    // Output order matches input order. If a stage throws, the others are cancelled and
+    // the first exception (in stage order) is rethrown once all three have stopped.
+    PipelineStats run_pipeline(std::istream &istr, std::ostream &ostr,
+                               const std::function<void(std::span<Fraction>)> &compute,
+                               const PipelineOptions &options = PipelineOptions());
+}
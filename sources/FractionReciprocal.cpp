@@ -0,0 +1,34 @@
+#include "FractionReciprocal.hpp"
+#include <vector>
+
+using namespace std;
+namespace ariel
+{
+    namespace detail
+    {
+        constinit thread_local ReciprocalTable thread_reciprocals{default_reciprocals.data(), DEFAULT_RECIPROCAL_BOUND};
+    }
+
+    void set_reciprocal_bound(uint32_t bound)
+    {
+        thread_local std::vector<uint64_t> custom;
+        if (bound == DEFAULT_RECIPROCAL_BOUND)
+        {
+            detail::thread_reciprocals = {detail::default_reciprocals.data(), bound};
+            return;
+        }
+        // Disable the table first so a failed allocation leaves a consistent state
+        detail::thread_reciprocals = {detail::default_reciprocals.data(), 0};
+        custom.resize(static_cast<std::size_t>(bound) + 1);
+        for (std::size_t divisor = 0; divisor < custom.size(); ++divisor)
+        {
+            custom[divisor] = reciprocal_of(static_cast<uint32_t>(divisor));
+        }
+        detail::thread_reciprocals = {custom.data(), bound};
+    }
+
+    uint32_t reciprocal_bound()
+    {
+        return detail::thread_reciprocals.bound;
+    }
+}
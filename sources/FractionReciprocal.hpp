@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace ariel
+{
+    // Multiply-shift reciprocals (libdivide / Lemire fastdiv): with M = floor((2^64 - 1) / d) + 1,
+    // n / d == (M * n) >> 64 exactly for every 32-bit n and 2 <= d < 2^32, so dividing by a
+    // small divisor costs one widening multiply instead of a hardware division.
+    constexpr uint64_t reciprocal_of(uint32_t divisor)
+    {
+        return divisor < 2 ? 0 : UINT64_MAX / divisor + 1;
+    }
+
+    // Divisors covered by a thread's table until set_reciprocal_bound changes it
+    constexpr uint32_t DEFAULT_RECIPROCAL_BOUND = 1024;
+
+    namespace detail
+    {
+        struct ReciprocalTable
+        {
+            const uint64_t *magic; // magic[d] for d in [0, bound]
+            uint32_t bound;
+        };
+
+        constexpr std::array<uint64_t, DEFAULT_RECIPROCAL_BOUND + 1> make_default_reciprocals()
+        {
+            std::array<uint64_t, DEFAULT_RECIPROCAL_BOUND + 1> magic{};
+            for (uint32_t divisor = 0; divisor <= DEFAULT_RECIPROCAL_BOUND; ++divisor)
+            {
+                magic[divisor] = reciprocal_of(divisor);
+            }
+            return magic;
+        }
+
+        // Built at compile time and shared read-only, so a thread that never reconfigures
+        // pays nothing to get one
+        inline constexpr std::array<uint64_t, DEFAULT_RECIPROCAL_BOUND + 1> default_reciprocals = make_default_reciprocals();
+
+        extern constinit thread_local ReciprocalTable thread_reciprocals;
+    }
+
+    // Rebuilds the calling thread's table for divisors up to bound (0 disables it, so every
+    // division goes to the hardware). Tables are per thread: no sharing, no synchronization.
+    void set_reciprocal_bound(uint32_t bound);
+    uint32_t reciprocal_bound();
+
+    // n / divisor for divisor >= 1, through the table when the divisor is small enough
+    inline uint32_t divide_small(uint32_t num, uint32_t divisor)
+    {
+        const detail::ReciprocalTable &table = detail::thread_reciprocals;
+        if (divisor <= table.bound)
+        {
+            auto quotient = static_cast<uint32_t>((static_cast<unsigned __int128>(table.magic[divisor]) * num) >> 64U);
+            return divisor == 1 ? num : quotient;
+        }
+        return num / divisor;
+    }
+}
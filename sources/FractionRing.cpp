@@ -0,0 +1,351 @@
+#include "FractionRing.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace std;
+namespace ariel
+{
+    constexpr std::size_t CACHE_LINE = 64;
+    constexpr uint32_t MAX_CAPACITY = 1U << 30U;
+    // Stored last by the creator; open() rejects segments that do not carry it yet
+    constexpr uint32_t RING_MAGIC = 0x46524E47U;
+
+    // Producer and consumer fields live on separate cache lines. Indices are free-running
+    // 32-bit counters; the wake sequences are the futex words each side sleeps on.
+    struct RingHeader
+    {
+        alignas(CACHE_LINE) std::atomic<uint32_t> head;
+        std::atomic<uint32_t> data_seq;
+        std::atomic<uint32_t> consumer_waiting;
+        alignas(CACHE_LINE) std::atomic<uint32_t> tail;
+        std::atomic<uint32_t> space_seq;
+        std::atomic<uint32_t> producer_waiting;
+        alignas(CACHE_LINE) uint32_t capacity;
+        std::atomic<uint32_t> closed;
+        std::atomic<uint32_t> ready;
+    };
+
+    static_assert(std::atomic<uint32_t>::is_always_lock_free, "futex words must be plain 32-bit integers");
+
+    static void futex_wait(std::atomic<uint32_t> &word, uint32_t expected)
+    {
+        // Returns on wake-up, on a value change (EAGAIN) or on a signal; callers re-check state
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT, expected, nullptr, nullptr, 0);
+    }
+
+    static void futex_wake(std::atomic<uint32_t> &word)
+    {
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+    }
+
+    static void notify(std::atomic<uint32_t> &waiting, std::atomic<uint32_t> &seq)
+    {
+        if (waiting.load() != 0)
+        {
+            seq.fetch_add(1);
+            futex_wake(seq);
+        }
+    }
+
+    std::size_t FractionRing::mapping_size(uint32_t capacity)
+    {
+        return sizeof(RingHeader) + static_cast<std::size_t>(capacity) * sizeof(uint64_t);
+    }
+
+    FractionRing::FractionRing(void *mapping, uint32_t capacity)
+        : mapping(mapping), length(mapping_size(capacity)), header(static_cast<RingHeader *>(mapping)),
+          slots(reinterpret_cast<uint64_t *>(static_cast<char *>(mapping) + sizeof(RingHeader))),
+          slot_count(capacity), mask(capacity - 1)
+    {
+        cached_tail = header->tail.load();
+        cached_head = header->head.load();
+    }
+
+    static uint32_t ring_capacity(uint32_t requested)
+    {
+        if (requested == 0 || requested > MAX_CAPACITY)
+        {
+            throw std::invalid_argument("Ring capacity must be between 1 and 2^30");
+        }
+        return std::bit_ceil(requested);
+    }
+
+    static void init_header(void *mapping, uint32_t capacity)
+    {
+        auto *header = new (mapping) RingHeader{};
+        header->capacity = capacity;
+        header->ready.store(RING_MAGIC, std::memory_order_release);
+    }
+
+    static void *map_shared(std::size_t length, int file)
+    {
+        int flags = file < 0 ? MAP_SHARED | MAP_ANONYMOUS : MAP_SHARED;
+        void *mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, file, 0);
+        if (mapping == MAP_FAILED)
+        {
+            throw std::system_error(errno, std::generic_category(), "mmap");
+        }
+        return mapping;
+    }
+
+    FractionRing::FractionRing(uint32_t capacity)
+    {
+        capacity = ring_capacity(capacity);
+        *this = FractionRing(map_shared(mapping_size(capacity), -1), capacity);
+        init_header(mapping, capacity);
+    }
+
+    FractionRing FractionRing::create(const std::string &name, uint32_t capacity)
+    {
+        capacity = ring_capacity(capacity);
+        int file = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (file < 0)
+        {
+            throw std::system_error(errno, std::generic_category(), "shm_open " + name);
+        }
+        std::size_t length = mapping_size(capacity);
+        if (ftruncate(file, static_cast<off_t>(length)) != 0)
+        {
+            int err = errno;
+            ::close(file);
+            shm_unlink(name.c_str());
+            throw std::system_error(err, std::generic_category(), "ftruncate " + name);
+        }
+        void *mapping = nullptr;
+        try
+        {
+            mapping = map_shared(length, file);
+        }
+        catch (...)
+        {
+            ::close(file);
+            shm_unlink(name.c_str());
+            throw;
+        }
+        ::close(file);
+        init_header(mapping, capacity);
+        return {mapping, capacity};
+    }
+
+    static std::size_t file_size(int file, const std::string &name)
+    {
+        struct stat info{};
+        if (fstat(file, &info) != 0)
+        {
+            throw std::system_error(errno, std::generic_category(), "fstat " + name);
+        }
+        return static_cast<std::size_t>(info.st_size);
+    }
+
+    // Validates a segment made by create() and returns its capacity. The header is
+    // only read once the file is known to cover it, and the ring only once the capacity
+    // is known to be sane and covered as well, so a half-created, truncated or foreign
+    // segment throws instead of faulting.
+    uint32_t FractionRing::shared_capacity(int file, const std::string &name)
+    {
+        if (file_size(file, name) < sizeof(RingHeader))
+        {
+            throw std::runtime_error("Shared ring " + name + " is too short for a header");
+        }
+        void *probe = map_shared(sizeof(RingHeader), file);
+        const auto *header = static_cast<const RingHeader *>(probe);
+        const bool ready = header->ready.load(std::memory_order_acquire) == RING_MAGIC;
+        const uint32_t capacity = header->capacity;
+        munmap(probe, sizeof(RingHeader));
+
+        if (!ready)
+        {
+            throw std::runtime_error("Shared ring " + name + " is not initialized");
+        }
+        if (capacity == 0 || capacity > MAX_CAPACITY || !std::has_single_bit(capacity))
+        {
+            throw std::runtime_error("Shared ring " + name + " has an invalid capacity");
+        }
+        if (file_size(file, name) < mapping_size(capacity))
+        {
+            throw std::runtime_error("Shared ring " + name + " is shorter than its capacity");
+        }
+        return capacity;
+    }
+
+    FractionRing FractionRing::open(const std::string &name)
+    {
+        int file = shm_open(name.c_str(), O_RDWR, 0);
+        if (file < 0)
+        {
+            throw std::system_error(errno, std::generic_category(), "shm_open " + name);
+        }
+        uint32_t capacity = 0;
+        void *mapping = nullptr;
+        try
+        {
+            capacity = shared_capacity(file, name);
+            mapping = map_shared(mapping_size(capacity), file);
+        }
+        catch (...)
+        {
+            ::close(file);
+            throw;
+        }
+        ::close(file);
+        return {mapping, capacity};
+    }
+
+    void FractionRing::unlink(const std::string &name)
+    {
+        shm_unlink(name.c_str());
+    }
+
+    FractionRing::FractionRing(FractionRing &&other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    FractionRing &FractionRing::operator=(FractionRing &&other) noexcept
+    {
+        if (this != &other)
+        {
+            if (mapping != nullptr)
+            {
+                munmap(mapping, length);
+            }
+            mapping = std::exchange(other.mapping, nullptr);
+            length = std::exchange(other.length, 0);
+            header = std::exchange(other.header, nullptr);
+            slots = std::exchange(other.slots, nullptr);
+            slot_count = std::exchange(other.slot_count, 0);
+            mask = std::exchange(other.mask, 0);
+            cached_tail = other.cached_tail;
+            cached_head = other.cached_head;
+        }
+        return *this;
+    }
+
+    FractionRing::~FractionRing()
+    {
+        if (mapping != nullptr)
+        {
+            munmap(mapping, length);
+        }
+    }
+
+    uint32_t FractionRing::capacity() const
+    {
+        return slot_count;
+    }
+
+    std::size_t FractionRing::try_publish(std::span<const Fraction> fractions)
+    {
+        const uint32_t head = header->head.load(std::memory_order_relaxed);
+        uint32_t space = slot_count - (head - cached_tail);
+        if (space < fractions.size())
+        {
+            cached_tail = header->tail.load(std::memory_order_acquire);
+            space = slot_count - (head - cached_tail);
+        }
+        auto count = static_cast<uint32_t>(std::min<std::size_t>(space, fractions.size()));
+        if (count == 0)
+        {
+            return 0;
+        }
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            slots[(head + i) & mask] = pack(fractions[i]);
+        }
+        // seq_cst pairs with the consumer's store to consumer_waiting (Dekker-style handshake)
+        header->head.store(head + count);
+        notify(header->consumer_waiting, header->data_seq);
+        return count;
+    }
+
+    void FractionRing::publish(std::span<const Fraction> fractions)
+    {
+        while (!fractions.empty())
+        {
+            const uint32_t seq = header->space_seq.load();
+            std::size_t count = try_publish(fractions);
+            fractions = fractions.subspan(count);
+            if (count != 0 || fractions.empty())
+            {
+                continue;
+            }
+            header->producer_waiting.store(1);
+            if (header->head.load(std::memory_order_relaxed) - header->tail.load() == slot_count)
+            {
+                futex_wait(header->space_seq, seq);
+            }
+            header->producer_waiting.store(0);
+        }
+    }
+
+    void FractionRing::close()
+    {
+        header->closed.store(1);
+        header->data_seq.fetch_add(1);
+        futex_wake(header->data_seq);
+    }
+
+    std::size_t FractionRing::try_consume(std::span<Fraction> out)
+    {
+        const uint32_t tail = header->tail.load(std::memory_order_relaxed);
+        uint32_t ready = cached_head - tail;
+        if (ready < out.size())
+        {
+            cached_head = header->head.load(std::memory_order_acquire);
+            ready = cached_head - tail;
+        }
+        auto count = static_cast<uint32_t>(std::min<std::size_t>(ready, out.size()));
+        if (count == 0)
+        {
+            return 0;
+        }
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            out[i] = unpack(slots[(tail + i) & mask]);
+        }
+        header->tail.store(tail + count);
+        notify(header->producer_waiting, header->space_seq);
+        return count;
+    }
+
+    std::size_t FractionRing::consume(std::span<Fraction> out)
+    {
+        if (out.empty())
+        {
+            return 0;
+        }
+        while (true)
+        {
+            const uint32_t seq = header->data_seq.load();
+            std::size_t count = try_consume(out);
+            if (count != 0)
+            {
+                return count;
+            }
+            if (header->closed.load() != 0)
+            {
+                // The producer may have published right before closing
+                return try_consume(out);
+            }
+            header->consumer_waiting.store(1);
+            if (header->head.load() == header->tail.load(std::memory_order_relaxed) && header->closed.load() == 0)
+            {
+                futex_wait(header->data_seq, seq);
+            }
+            header->consumer_waiting.store(0);
+        }
+    }
+}
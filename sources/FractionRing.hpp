@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+#include "Fraction.hpp"
+
+namespace ariel
+{
+    struct RingHeader;
+
+    // Single-producer/single-consumer ring of packed fractions in shared memory.
+    // Stages on one host exchange fractions without any text formatting or parsing;
+    // blocked sides sleep on a futex and are woken only when the other side moves.
+    class FractionRing
+    {
+    public:
+        // Anonymous shared mapping, inherited by children across fork()
+        explicit FractionRing(uint32_t capacity);
+        // Named POSIX shared memory object (shm_open); the creator sizes and initializes it
+        static FractionRing create(const std::string &name, uint32_t capacity);
+        // std::runtime_error if the object is not a fully created ring of a valid size
+        static FractionRing open(const std::string &name);
+        static void unlink(const std::string &name);
+
+        FractionRing(const FractionRing &) = delete;
+        FractionRing &operator=(const FractionRing &) = delete;
+        FractionRing(FractionRing &&other) noexcept;
+        FractionRing &operator=(FractionRing &&other) noexcept;
+        ~FractionRing();
+
+        // Producer side: publish as many as fit and return the count, or block until all are in
+        std::size_t try_publish(std::span<const Fraction> fractions);
+        void publish(std::span<const Fraction> fractions);
+        // Marks the end of the stream and wakes a waiting consumer
+        void close();
+
+        // Consumer side: take up to out.size() fractions; consume blocks until at least one
+        // is available and returns 0 only once the ring is closed and drained
+        std::size_t try_consume(std::span<Fraction> out);
+        std::size_t consume(std::span<Fraction> out);
+
+        uint32_t capacity() const;
+
+    private:
+        FractionRing(void *mapping, uint32_t capacity);
+        static std::size_t mapping_size(uint32_t capacity);
+        static uint32_t shared_capacity(int file, const std::string &name);
+
+        void *mapping = nullptr;
+        std::size_t length = 0;
+        RingHeader *header = nullptr;
+        uint64_t *slots = nullptr;
+        // Validated capacity kept out of the shared segment, so a peer cannot change it
+        uint32_t slot_count = 0;
+        uint32_t mask = 0;
+        // Process-local copies of the other side's index, refreshed only when the ring looks full/empty
+        uint32_t cached_tail = 0;
+        uint32_t cached_head = 0;
+    };
+}
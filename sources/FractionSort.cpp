@@ -0,0 +1,202 @@
+#include "FractionSort.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace std;
+namespace ariel
+{
+    int exact_compare(const Fraction &lhs, const Fraction &rhs)
+    {
+        int64_t left = static_cast<int64_t>(lhs.getNumerator()) * rhs.getDenominator();
+        int64_t right = static_cast<int64_t>(rhs.getNumerator()) * lhs.getDenominator();
+        if ((lhs.getDenominator() < 0) != (rhs.getDenominator() < 0))
+        {
+            std::swap(left, right);
+        }
+        return (left > right) - (left < right);
+    }
+
+    struct KeyedFraction
+    {
+        uint64_t key;
+        uint64_t word;
+    };
+
+    // Correctly rounded division is monotone, so equal exact values give equal keys and
+    // ordered values give non-decreasing keys; the bit twiddle maps double order to uint order
+    static uint64_t sort_key(const Fraction &fraction)
+    {
+        double value = static_cast<double>(fraction.getNumerator()) / fraction.getDenominator();
+        auto bits = std::bit_cast<uint64_t>(value + 0.0);
+        return (bits >> 63U) != 0 ? ~bits : bits | (uint64_t{1} << 63U);
+    }
+
+    static bool keyed_less(const KeyedFraction &lhs, const KeyedFraction &rhs)
+    {
+        if (lhs.key != rhs.key)
+        {
+            return lhs.key < rhs.key;
+        }
+        return exact_less(unpack(lhs.word), unpack(rhs.word));
+    }
+
+    // LSD radix sort by key, 11 bits per pass (2048-entry histograms stay in L1);
+    // passes where every key shares the digit are skipped
+    static void radix_sort(std::span<KeyedFraction> items, std::span<KeyedFraction> scratch)
+    {
+        constexpr std::size_t BITS = 11;
+        constexpr std::size_t PASSES = (64 + BITS - 1) / BITS;
+        constexpr std::size_t BUCKETS = std::size_t{1} << BITS;
+        constexpr uint64_t MASK = BUCKETS - 1;
+        std::vector<std::array<std::size_t, BUCKETS>> counts(PASSES);
+        for (auto &count : counts)
+        {
+            count.fill(0);
+        }
+        for (const KeyedFraction &item : items)
+        {
+            for (std::size_t pass = 0; pass < PASSES; ++pass)
+            {
+                ++counts[pass][(item.key >> (BITS * pass)) & MASK];
+            }
+        }
+
+        std::span<KeyedFraction> src = items;
+        std::span<KeyedFraction> dst = scratch;
+        for (std::size_t pass = 0; pass < PASSES; ++pass)
+        {
+            auto &count = counts[pass];
+            if (std::find(count.begin(), count.end(), items.size()) != count.end())
+            {
+                continue;
+            }
+            std::size_t offset = 0;
+            for (std::size_t &bucket : count)
+            {
+                std::size_t size = bucket;
+                bucket = offset;
+                offset += size;
+            }
+            for (const KeyedFraction &item : src)
+            {
+                dst[count[(item.key >> (BITS * pass)) & MASK]++] = item;
+            }
+            std::swap(src, dst);
+        }
+        if (src.data() != items.data())
+        {
+            std::copy(src.begin(), src.end(), items.begin());
+        }
+
+        // Exact tie-break inside runs of equal keys; runs of one repeated value are already in order
+        for (std::size_t first = 0; first < items.size();)
+        {
+            std::size_t last = first + 1;
+            bool mixed = false;
+            while (last < items.size() && items[last].key == items[first].key)
+            {
+                mixed = mixed || items[last].word != items[first].word;
+                ++last;
+            }
+            if (mixed)
+            {
+                std::sort(items.begin() + static_cast<std::ptrdiff_t>(first), items.begin() + static_cast<std::ptrdiff_t>(last), keyed_less);
+            }
+            first = last;
+        }
+    }
+
+    static void load(std::span<const Fraction> fractions, std::span<KeyedFraction> items)
+    {
+        for (std::size_t i = 0; i < fractions.size(); ++i)
+        {
+            items[i] = KeyedFraction{sort_key(fractions[i]), pack(fractions[i])};
+        }
+    }
+
+    static void store(std::span<const KeyedFraction> items, std::span<Fraction> fractions)
+    {
+        for (std::size_t i = 0; i < items.size(); ++i)
+        {
+            fractions[i] = unpack(items[i].word);
+        }
+    }
+
+    void sort(std::span<Fraction> fractions)
+    {
+        std::vector<KeyedFraction> items(fractions.size());
+        std::vector<KeyedFraction> scratch(fractions.size());
+        load(fractions, items);
+        radix_sort(items, scratch);
+        store(items, fractions);
+    }
+
+    void parallel_sort(std::span<Fraction> fractions, unsigned threads)
+    {
+        if (threads == 0)
+        {
+            threads = std::max(1U, std::thread::hardware_concurrency());
+        }
+        const std::size_t size = fractions.size();
+        std::size_t chunks = std::min<std::size_t>(threads, std::max<std::size_t>(size / 4096, 1));
+        if (chunks <= 1)
+        {
+            sort(fractions);
+            return;
+        }
+
+        std::vector<KeyedFraction> items(size);
+        std::vector<KeyedFraction> scratch(size);
+        std::vector<std::size_t> bounds(chunks + 1);
+        for (std::size_t i = 0; i <= chunks; ++i)
+        {
+            bounds[i] = size * i / chunks;
+        }
+
+        // Each worker keys and radix-sorts its own chunk
+        std::vector<std::thread> workers;
+        for (std::size_t chunk = 0; chunk < chunks; ++chunk)
+        {
+            workers.emplace_back([&, chunk]
+                                 {
+                std::size_t first = bounds[chunk];
+                std::size_t count = bounds[chunk + 1] - first;
+                std::span<KeyedFraction> part(items.data() + first, count);
+                load(fractions.subspan(first, count), part);
+                radix_sort(part, std::span<KeyedFraction>(scratch.data() + first, count)); });
+        }
+        for (std::thread &worker : workers)
+        {
+            worker.join();
+        }
+
+        // Pairwise merge rounds; each merge in a round runs on its own thread
+        std::vector<KeyedFraction> *src = &items;
+        std::vector<KeyedFraction> *dst = &scratch;
+        for (std::size_t width = 1; width < chunks; width *= 2)
+        {
+            workers.clear();
+            for (std::size_t left = 0; left < chunks; left += 2 * width)
+            {
+                std::size_t mid = std::min(left + width, chunks);
+                std::size_t right = std::min(left + 2 * width, chunks);
+                workers.emplace_back([=, &bounds]
+                                     {
+                    auto begin = [&](std::vector<KeyedFraction> *vec, std::size_t idx)
+                    { return vec->begin() + static_cast<std::ptrdiff_t>(bounds[idx]); };
+                    std::merge(begin(src, left), begin(src, mid), begin(src, mid), begin(src, right),
+                               begin(dst, left), keyed_less); });
+            }
+            for (std::thread &worker : workers)
+            {
+                worker.join();
+            }
+            std::swap(src, dst);
+        }
+        store(*src, fractions);
+    }
+}
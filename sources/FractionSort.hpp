@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+#include "Fraction.hpp"
+
+namespace ariel
+{
+    // Exact three-way comparison through 64-bit cross products; never overflows
+    int exact_compare(const Fraction &lhs, const Fraction &rhs);
+
+    inline bool exact_less(const Fraction &lhs, const Fraction &rhs)
+    {
+        return exact_compare(lhs, rhs) < 0;
+    }
+
+    // Sorts ascending by exact value. An LSD radix sort on the order-preserving bits of
+    // numerator/denominator as a double (monotone in the exact value) does the bulk of the
+    // work; runs whose keys collide are then fixed up with exact_compare.
+    void sort(std::span<Fraction> fractions);
+
+    // Same ordering; chunks are radix-sorted on separate threads and merged pairwise.
+    // threads == 0 uses std::thread::hardware_concurrency().
+    void parallel_sort(std::span<Fraction> fractions, unsigned threads = 0);
+}
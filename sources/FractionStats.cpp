@@ -0,0 +1,277 @@
+#include "FractionStats.hpp"
+#include "FractionSort.hpp"
+#include <stdexcept>
+
+using namespace std;
+namespace ariel
+{
+    using Wide = __int128;
+    using UWide = unsigned __int128;
+
+    static UWide wide_gcd(UWide num_a, UWide num_b)
+    {
+        while (num_b != 0)
+        {
+            UWide rest = num_a % num_b;
+            num_a = num_b;
+            num_b = rest;
+        }
+        return num_a;
+    }
+
+    static UWide wide_abs(Wide value)
+    {
+        return value < 0 ? UWide(0) - static_cast<UWide>(value) : static_cast<UWide>(value);
+    }
+
+    // Reduces num/den (den > 0) and narrows it to a Fraction
+    static Fraction narrow(Wide num, Wide den)
+    {
+        auto gcd_ = static_cast<Wide>(wide_gcd(wide_abs(num), static_cast<UWide>(den)));
+        num /= gcd_;
+        den /= gcd_;
+        if (num > INT32_MAX || num < -INT32_MAX || den > INT32_MAX)
+        {
+            throw std::overflow_error("Accumulator result does not fit in a Fraction");
+        }
+        return Fraction::from_reduced(static_cast<int>(num), static_cast<int>(den));
+    }
+
+    // Rescales (lcm, sum, squares) to also cover den and adds num/den. T is int64_t or Wide.
+    template <typename T>
+    static bool add_term(T &lcm, T &sum, T &squares, T num, T den)
+    {
+        T gcd_ = static_cast<T>(wide_gcd(static_cast<UWide>(lcm), static_cast<UWide>(den)));
+        T scale = den / gcd_;
+        if (scale != 1)
+        {
+            T scale_sq = 0;
+            if (__builtin_mul_overflow(scale, scale, &scale_sq) ||
+                __builtin_mul_overflow(lcm, scale, &lcm) ||
+                __builtin_mul_overflow(sum, scale, &sum) ||
+                __builtin_mul_overflow(squares, scale_sq, &squares))
+            {
+                return false;
+            }
+        }
+        T factor = lcm / den;
+        T term = 0;
+        T term_sq = 0;
+        return !__builtin_mul_overflow(num, factor, &term) &&
+               !__builtin_add_overflow(sum, term, &sum) &&
+               !__builtin_mul_overflow(term, term, &term_sq) &&
+               !__builtin_add_overflow(squares, term_sq, &squares);
+    }
+
+    void FractionAccumulator::widen()
+    {
+        wide = true;
+        wide_lcm = lcm;
+        wide_sum = sum_num;
+        wide_squares = squares_num;
+    }
+
+    void FractionAccumulator::add(const Fraction &value)
+    {
+        int64_t num = value.getNumerator();
+        int64_t den = value.getDenominator();
+        if (den < 0)
+        {
+            num = -num;
+            den = -den;
+        }
+
+        if (!wide)
+        {
+            // Work on copies so a failed update leaves the narrow state intact for widening
+            int64_t new_lcm = lcm;
+            int64_t new_sum = sum_num;
+            int64_t new_squares = squares_num;
+            if (add_term<int64_t>(new_lcm, new_sum, new_squares, num, den))
+            {
+                lcm = new_lcm;
+                sum_num = new_sum;
+                squares_num = new_squares;
+            }
+            else
+            {
+                widen();
+            }
+        }
+        if (wide && !add_term<Wide>(wide_lcm, wide_sum, wide_squares, num, den))
+        {
+            throw std::overflow_error("Overflow in FractionAccumulator");
+        }
+
+        if (items == 0 || exact_less(value, lowest))
+        {
+            lowest = value;
+        }
+        if (items == 0 || exact_less(highest, value))
+        {
+            highest = value;
+        }
+        ++items;
+    }
+
+    void FractionAccumulator::add(std::span<const Fraction> values)
+    {
+        for (const Fraction &value : values)
+        {
+            add(value);
+        }
+    }
+
+    void FractionAccumulator::merge_state(Wide other_lcm, Wide other_sum, Wide other_squares)
+    {
+        if (!wide)
+        {
+            widen();
+        }
+        auto gcd_ = static_cast<Wide>(wide_gcd(static_cast<UWide>(wide_lcm), static_cast<UWide>(other_lcm)));
+        Wide mine = other_lcm / gcd_;
+        Wide theirs = wide_lcm / gcd_;
+        Wide new_lcm = 0;
+        Wide scaled = 0;
+        Wide scaled_other = 0;
+        Wide mine_sq = 0;
+        Wide theirs_sq = 0;
+        if (__builtin_mul_overflow(wide_lcm, mine, &new_lcm) ||
+            __builtin_mul_overflow(mine, mine, &mine_sq) ||
+            __builtin_mul_overflow(theirs, theirs, &theirs_sq) ||
+            __builtin_mul_overflow(wide_sum, mine, &scaled) ||
+            __builtin_mul_overflow(other_sum, theirs, &scaled_other) ||
+            __builtin_add_overflow(scaled, scaled_other, &wide_sum) ||
+            __builtin_mul_overflow(wide_squares, mine_sq, &scaled) ||
+            __builtin_mul_overflow(other_squares, theirs_sq, &scaled_other) ||
+            __builtin_add_overflow(scaled, scaled_other, &wide_squares))
+        {
+            throw std::overflow_error("Overflow in FractionAccumulator merge");
+        }
+        wide_lcm = new_lcm;
+    }
+
+    void FractionAccumulator::merge(const FractionAccumulator &other)
+    {
+        if (other.items == 0)
+        {
+            return;
+        }
+        if (!wide && !other.wide)
+        {
+            // Stay narrow when the merged state still fits in 64 bits
+            FractionAccumulator narrow_copy = *this;
+            narrow_copy.merge_state(other.lcm, other.sum_num, other.squares_num);
+            if (narrow_copy.wide_lcm <= INT64_MAX && narrow_copy.wide_sum <= INT64_MAX && narrow_copy.wide_sum >= INT64_MIN &&
+                narrow_copy.wide_squares <= INT64_MAX)
+            {
+                lcm = static_cast<int64_t>(narrow_copy.wide_lcm);
+                sum_num = static_cast<int64_t>(narrow_copy.wide_sum);
+                squares_num = static_cast<int64_t>(narrow_copy.wide_squares);
+            }
+            else
+            {
+                *this = narrow_copy;
+            }
+        }
+        else if (other.wide)
+        {
+            merge_state(other.wide_lcm, other.wide_sum, other.wide_squares);
+        }
+        else
+        {
+            merge_state(other.lcm, other.sum_num, other.squares_num);
+        }
+
+        if (items == 0 || exact_less(other.lowest, lowest))
+        {
+            lowest = other.lowest;
+        }
+        if (items == 0 || exact_less(highest, other.highest))
+        {
+            highest = other.highest;
+        }
+        items += other.items;
+    }
+
+    uint64_t FractionAccumulator::count() const
+    {
+        return items;
+    }
+
+    bool FractionAccumulator::is_wide() const
+    {
+        return wide;
+    }
+
+    Fraction FractionAccumulator::sum() const
+    {
+        return wide ? narrow(wide_sum, wide_lcm) : narrow(sum_num, lcm);
+    }
+
+    Fraction FractionAccumulator::sum_of_squares() const
+    {
+        Wide den = wide ? wide_lcm : lcm;
+        Wide den_sq = 0;
+        if (__builtin_mul_overflow(den, den, &den_sq))
+        {
+            throw std::overflow_error("Overflow in FractionAccumulator sum of squares");
+        }
+        return narrow(wide ? wide_squares : squares_num, den_sq);
+    }
+
+    static void require_items(uint64_t items)
+    {
+        if (items == 0)
+        {
+            throw std::runtime_error("FractionAccumulator is empty");
+        }
+    }
+
+    Fraction FractionAccumulator::mean() const
+    {
+        require_items(items);
+        Wide den = 0;
+        if (__builtin_mul_overflow(static_cast<Wide>(wide ? wide_lcm : lcm), static_cast<Wide>(items), &den))
+        {
+            throw std::overflow_error("Overflow in FractionAccumulator mean");
+        }
+        return narrow(wide ? wide_sum : sum_num, den);
+    }
+
+    Fraction FractionAccumulator::variance() const
+    {
+        // (n * Q - S^2) / (n^2 * L^2)
+        require_items(items);
+        Wide total = wide ? wide_sum : sum_num;
+        Wide squares = wide ? wide_squares : squares_num;
+        Wide den = wide ? wide_lcm : lcm;
+        auto count = static_cast<Wide>(items);
+        Wide lhs = 0;
+        Wide rhs = 0;
+        Wide num = 0;
+        Wide scale = 0;
+        Wide out_den = 0;
+        if (__builtin_mul_overflow(count, squares, &lhs) ||
+            __builtin_mul_overflow(total, total, &rhs) ||
+            __builtin_sub_overflow(lhs, rhs, &num) ||
+            __builtin_mul_overflow(count, den, &scale) ||
+            __builtin_mul_overflow(scale, scale, &out_den))
+        {
+            throw std::overflow_error("Overflow in FractionAccumulator variance");
+        }
+        return narrow(num, out_den);
+    }
+
+    Fraction FractionAccumulator::min() const
+    {
+        require_items(items);
+        return lowest;
+    }
+
+    Fraction FractionAccumulator::max() const
+    {
+        require_items(items);
+        return highest;
+    }
+}
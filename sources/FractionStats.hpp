@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "Fraction.hpp"
+
+namespace ariel
+{
+    // Exact running aggregates over a stream of fractions. The sum and the sum of squares
+    // are kept as integer numerators over a running lcm L of the denominators (L and L^2),
+    // so adding a value is a multiply-add with no reduction. State lives in 64-bit words and
+    // is promoted to 128 bits the first time an update would overflow.
+    class FractionAccumulator
+    {
+    public:
+        void add(const Fraction &value);
+        void add(std::span<const Fraction> values);
+        // Folds in a partial accumulator, e.g. one per thread in a parallel aggregation
+        void merge(const FractionAccumulator &other);
+
+        uint64_t count() const;
+        bool is_wide() const;
+
+        // Results are reduced to a Fraction; std::overflow_error if they do not fit in int,
+        // std::runtime_error for mean, variance, min and max of an empty stream
+        Fraction sum() const;
+        Fraction sum_of_squares() const;
+        Fraction mean() const;
+        Fraction variance() const; // population variance
+        Fraction min() const;
+        Fraction max() const;
+
+    private:
+        using Wide = __int128;
+
+        void widen();
+        void merge_state(Wide other_lcm, Wide other_sum, Wide other_squares);
+
+        uint64_t items = 0;
+        bool wide = false;
+        int64_t lcm = 1;
+        int64_t sum_num = 0;     // sum == sum_num / lcm
+        int64_t squares_num = 0; // sum of squares == squares_num / lcm^2
+        Wide wide_lcm = 1;
+        Wide wide_sum = 0;
+        Wide wide_squares = 0;
+        Fraction lowest;
+        Fraction highest;
+    };
+}
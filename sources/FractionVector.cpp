@@ -0,0 +1,311 @@
+#include "FractionVector.hpp"
+#include "FractionMath.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FRACTION_HAVE_X86 1
+#endif
+
+using namespace std;
+namespace ariel
+{
+    // Kernels are processed in blocks so the 64-bit intermediates stay in L1
+    constexpr std::size_t BLOCK = 1024;
+
+    enum class Kernel
+    {
+        ADD,
+        SUB,
+        MUL,
+        DIV
+    };
+
+    // Unreduced 64-bit cross products of one block; 32x32-bit products cannot overflow int64
+    template <Kernel K>
+    static void cross_scalar(const int *a_num, const int *a_den, const int *b_num, const int *b_den,
+                             int64_t *num, int64_t *den, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            int64_t a_n = a_num[i];
+            int64_t a_d = a_den[i];
+            int64_t b_n = b_num[i];
+            int64_t b_d = b_den[i];
+            switch (K)
+            {
+            case Kernel::ADD:
+                num[i] = a_n * b_d + b_n * a_d;
+                den[i] = a_d * b_d;
+                break;
+            case Kernel::SUB:
+                num[i] = a_n * b_d - b_n * a_d;
+                den[i] = a_d * b_d;
+                break;
+            case Kernel::MUL:
+                num[i] = a_n * b_n;
+                den[i] = a_d * b_d;
+                break;
+            case Kernel::DIV:
+                num[i] = a_n * b_d;
+                den[i] = a_d * b_n;
+                break;
+            }
+        }
+    }
+
+#ifdef FRACTION_HAVE_X86
+    // Four lanes per step: sign-extend to 64 bits, then vpmuldq gives exact products
+    template <Kernel K>
+    __attribute__((target("avx2"))) static void cross_avx2(const int *a_num, const int *a_den, const int *b_num, const int *b_den,
+                                                           int64_t *num, int64_t *den, std::size_t count)
+    {
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m256i a_n = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a_num + i)));
+            __m256i a_d = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a_den + i)));
+            __m256i b_n = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i *>(b_num + i)));
+            __m256i b_d = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i *>(b_den + i)));
+            __m256i out_n;
+            __m256i out_d;
+            switch (K)
+            {
+            case Kernel::ADD:
+                out_n = _mm256_add_epi64(_mm256_mul_epi32(a_n, b_d), _mm256_mul_epi32(b_n, a_d));
+                out_d = _mm256_mul_epi32(a_d, b_d);
+                break;
+            case Kernel::SUB:
+                out_n = _mm256_sub_epi64(_mm256_mul_epi32(a_n, b_d), _mm256_mul_epi32(b_n, a_d));
+                out_d = _mm256_mul_epi32(a_d, b_d);
+                break;
+            case Kernel::MUL:
+                out_n = _mm256_mul_epi32(a_n, b_n);
+                out_d = _mm256_mul_epi32(a_d, b_d);
+                break;
+            case Kernel::DIV:
+                out_n = _mm256_mul_epi32(a_n, b_d);
+                out_d = _mm256_mul_epi32(a_d, b_n);
+                break;
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(num + i), out_n);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(den + i), out_d);
+        }
+        cross_scalar<K>(a_num + i, a_den + i, b_num + i, b_den + i, num + i, den + i, count - i);
+    }
+#endif
+
+    bool fraction_vector_uses_avx2()
+    {
+#ifdef FRACTION_HAVE_X86
+        static const bool has_avx2 = __builtin_cpu_supports("avx2") != 0;
+        return has_avx2;
+#else
+        return false;
+#endif
+    }
+
+    template <Kernel K>
+    static void cross(const int *a_num, const int *a_den, const int *b_num, const int *b_den,
+                      int64_t *num, int64_t *den, std::size_t count)
+    {
+#ifdef FRACTION_HAVE_X86
+        if (fraction_vector_uses_avx2())
+        {
+            cross_avx2<K>(a_num, a_den, b_num, b_den, num, den, count);
+            return;
+        }
+#endif
+        cross_scalar<K>(a_num, a_den, b_num, b_den, num, den, count);
+    }
+
+    static void check_sizes(const FractionVector &lhs, const FractionVector &rhs)
+    {
+        if (lhs.size() != rhs.size())
+        {
+            throw std::invalid_argument("FractionVector sizes differ");
+        }
+    }
+
+    template <Kernel K>
+    static FractionVector elementwise(const FractionVector &lhs, const FractionVector &rhs)
+    {
+        check_sizes(lhs, rhs);
+        FractionVector result(lhs.size());
+        int *out_num = result.numerators();
+        int *out_den = result.denominators();
+        int64_t num[BLOCK];
+        int64_t den[BLOCK];
+        bool overflow = false;
+        bool div_zero = false;
+        for (std::size_t first = 0; first < lhs.size(); first += BLOCK)
+        {
+            std::size_t count = std::min(BLOCK, lhs.size() - first);
+            cross<K>(lhs.numerators() + first, lhs.denominators() + first,
+                     rhs.numerators() + first, rhs.denominators() + first, num, den, count);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                int64_t n = num[i];
+                int64_t d = den[i];
+                if (K == Kernel::DIV)
+                {
+                    div_zero = div_zero || d == 0;
+                    if (d < 0)
+                    {
+                        n = -n;
+                        d = -d;
+                    }
+                }
+                if (d == 0 || !reduce_to_int(n, d, out_num[first + i], out_den[first + i]))
+                {
+                    overflow = overflow || d != 0;
+                }
+            }
+            if (div_zero)
+            {
+                throw std::runtime_error("Division by zero");
+            }
+            if (overflow)
+            {
+                throw std::overflow_error("Overflow in FractionVector operation");
+            }
+        }
+        return result;
+    }
+
+    FractionVector::FractionVector(std::size_t size) : nums(size, 0), dens(size, 1) {}
+
+    FractionVector::FractionVector(std::span<const Fraction> fractions)
+    {
+        nums.reserve(fractions.size());
+        dens.reserve(fractions.size());
+        for (const Fraction &fraction : fractions)
+        {
+            push_back(fraction);
+        }
+    }
+
+    std::size_t FractionVector::size() const
+    {
+        return nums.size();
+    }
+
+    Fraction FractionVector::operator[](std::size_t index) const
+    {
+        return Fraction::from_reduced(nums[index], dens[index]);
+    }
+
+    void FractionVector::set(std::size_t index, const Fraction &fraction)
+    {
+        nums[index] = fraction.getNumerator();
+        dens[index] = fraction.getDenominator();
+    }
+
+    void FractionVector::push_back(const Fraction &fraction)
+    {
+        nums.push_back(fraction.getNumerator());
+        dens.push_back(fraction.getDenominator());
+    }
+
+    std::vector<Fraction> FractionVector::to_vector() const
+    {
+        std::vector<Fraction> out;
+        out.reserve(size());
+        for (std::size_t i = 0; i < size(); ++i)
+        {
+            out.push_back((*this)[i]);
+        }
+        return out;
+    }
+
+    int *FractionVector::numerators()
+    {
+        return nums.data();
+    }
+
+    int *FractionVector::denominators()
+    {
+        return dens.data();
+    }
+
+    const int *FractionVector::numerators() const
+    {
+        return nums.data();
+    }
+
+    const int *FractionVector::denominators() const
+    {
+        return dens.data();
+    }
+
+    FractionVector add(const FractionVector &lhs, const FractionVector &rhs)
+    {
+        return elementwise<Kernel::ADD>(lhs, rhs);
+    }
+
+    FractionVector sub(const FractionVector &lhs, const FractionVector &rhs)
+    {
+        return elementwise<Kernel::SUB>(lhs, rhs);
+    }
+
+    FractionVector mul(const FractionVector &lhs, const FractionVector &rhs)
+    {
+        return elementwise<Kernel::MUL>(lhs, rhs);
+    }
+
+    FractionVector div(const FractionVector &lhs, const FractionVector &rhs)
+    {
+        return elementwise<Kernel::DIV>(lhs, rhs);
+    }
+
+    std::vector<int8_t> compare(const FractionVector &lhs, const FractionVector &rhs)
+    {
+        check_sizes(lhs, rhs);
+        std::vector<int8_t> result(lhs.size());
+        int64_t num[BLOCK];
+        int64_t den[BLOCK];
+        for (std::size_t first = 0; first < lhs.size(); first += BLOCK)
+        {
+            std::size_t count = std::min(BLOCK, lhs.size() - first);
+            // Denominators are positive, so the sign of the SUB numerator is the ordering
+            cross<Kernel::SUB>(lhs.numerators() + first, lhs.denominators() + first,
+                               rhs.numerators() + first, rhs.denominators() + first, num, den, count);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                result[first + i] = static_cast<int8_t>((num[i] > 0) - (num[i] < 0));
+            }
+        }
+        return result;
+    }
+
+    Fraction FractionVector::sum() const
+    {
+        // Running sum over the lcm of denominators seen so far, reduced at every step
+        int64_t num = 0;
+        int64_t den = 1;
+        for (std::size_t i = 0; i < size(); ++i)
+        {
+            auto gcd_ = static_cast<int64_t>(binary_gcd(static_cast<uint64_t>(den), static_cast<uint64_t>(dens[i])));
+            int64_t scale = dens[i] / gcd_;
+            int64_t term = 0;
+            if (__builtin_mul_overflow(num, scale, &num) ||
+                __builtin_mul_overflow(static_cast<int64_t>(nums[i]), den / gcd_, &term) ||
+                __builtin_add_overflow(num, term, &num) ||
+                __builtin_mul_overflow(den, scale, &den))
+            {
+                throw std::overflow_error("Overflow in FractionVector sum");
+            }
+            gcd_ = static_cast<int64_t>(binary_gcd(magnitude(num), static_cast<uint64_t>(den)));
+            num /= gcd_;
+            den /= gcd_;
+        }
+        int out_num = 0;
+        int out_den = 1;
+        if (!reduce_to_int(num, den, out_num, out_den))
+        {
+            throw std::overflow_error("Overflow in FractionVector sum");
+        }
+        return Fraction::from_reduced(out_num, out_den);
+    }
+}
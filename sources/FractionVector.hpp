@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <span>
+#include <vector>
+
+#include "Fraction.hpp"
+
+namespace ariel
+{
+    // Minimal allocator returning Alignment-aligned blocks, for SIMD-friendly columns
+    template <typename T, std::size_t Alignment = 64>
+    struct AlignedAllocator
+    {
+        using value_type = T;
+        template <typename U>
+        struct rebind
+        {
+            using other = AlignedAllocator<U, Alignment>;
+        };
+
+        AlignedAllocator() = default;
+        template <typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment> & /*other*/) {}
+
+        T *allocate(std::size_t count)
+        {
+            return static_cast<T *>(::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+        }
+        void deallocate(T *ptr, std::size_t /*count*/)
+        {
+            ::operator delete(ptr, std::align_val_t(Alignment));
+        }
+
+        template <typename U>
+        bool operator==(const AlignedAllocator<U, Alignment> & /*other*/) const { return true; }
+    };
+
+    template <typename T>
+    using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+    // Structure-of-arrays column of fractions: numerators and denominators in separate
+    // 64-byte aligned arrays, so the elementwise kernels below can run 4 lanes at a time
+    // (AVX2 when the CPU has it, scalar otherwise). Elements are kept reduced with a
+    // positive denominator.
+    class FractionVector
+    {
+    public:
+        FractionVector() = default;
+        explicit FractionVector(std::size_t size);
+        FractionVector(std::span<const Fraction> fractions);
+
+        std::size_t size() const;
+        Fraction operator[](std::size_t index) const;
+        void set(std::size_t index, const Fraction &fraction);
+        void push_back(const Fraction &fraction);
+        std::vector<Fraction> to_vector() const;
+
+        // Raw columns; writers must keep each pair reduced with a positive denominator
+        int *numerators();
+        int *denominators();
+        const int *numerators() const;
+        const int *denominators() const;
+
+        // Elementwise kernels; sizes must match. Throw std::overflow_error if any reduced
+        // result does not fit in int, std::runtime_error on division by zero.
+        friend FractionVector add(const FractionVector &lhs, const FractionVector &rhs);
+        friend FractionVector sub(const FractionVector &lhs, const FractionVector &rhs);
+        friend FractionVector mul(const FractionVector &lhs, const FractionVector &rhs);
+        friend FractionVector div(const FractionVector &lhs, const FractionVector &rhs);
+        // Exact three-way comparison per element: -1, 0 or 1
+        friend std::vector<int8_t> compare(const FractionVector &lhs, const FractionVector &rhs);
+
+        // Exact sum of all elements
+        Fraction sum() const;
+
+    private:
+        AlignedVector<int> nums;
+        AlignedVector<int> dens;
+    };
+
+    // True when the elementwise kernels run on AVX2
+    bool fraction_vector_uses_avx2();
+}
@@ -0,0 +1,295 @@
+#include "NumaFractionArray.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace std;
+namespace ariel
+{
+    // Ids listed in a /sys range list such as "0-3,8-11"
+    static std::vector<int> parse_id_list(const std::string &text)
+    {
+        std::vector<int> ids;
+        std::istringstream input(text);
+        std::string range;
+        while (std::getline(input, range, ','))
+        {
+            int first = 0;
+            int last = 0;
+            char dash = 0;
+            std::istringstream parts(range);
+            if (!(parts >> first))
+            {
+                continue;
+            }
+            last = parts >> dash >> last && dash == '-' ? last : first;
+            for (int id = first; id <= last; ++id)
+            {
+                ids.push_back(id);
+            }
+        }
+        return ids;
+    }
+
+    static std::string read_line(const std::string &path)
+    {
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+        return line;
+    }
+
+    // (node, cpu) for every CPU the process may run on, ordered by node so the partitions
+    // of one node are adjacent. Without NUMA information every CPU is on node 0; if the
+    // affinity mask is unavailable a single unpinned entry (cpu -1) is returned.
+    static std::vector<std::pair<int, int>> allowed_cpus()
+    {
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+        {
+            return {{0, -1}};
+        }
+        std::vector<int> node_of(CPU_SETSIZE, 0);
+        for (int node : parse_id_list(read_line("/sys/devices/system/node/online")))
+        {
+            for (int cpu : parse_id_list(read_line("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist")))
+            {
+                if (cpu >= 0 && cpu < CPU_SETSIZE)
+                {
+                    node_of[static_cast<std::size_t>(cpu)] = node;
+                }
+            }
+        }
+        std::vector<std::pair<int, int>> cpus;
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (CPU_ISSET(static_cast<std::size_t>(cpu), &allowed))
+            {
+                cpus.emplace_back(node_of[static_cast<std::size_t>(cpu)], cpu);
+            }
+        }
+        if (cpus.empty())
+        {
+            return {{0, -1}};
+        }
+        std::stable_sort(cpus.begin(), cpus.end());
+        return cpus;
+    }
+
+    // Prefers node for the pages of [addr, addr + bytes) (numa_tonode_memory as a raw
+    // syscall). The pages are not touched yet, so the policy decides where they land.
+    static bool bind_to_node(void *addr, std::size_t bytes, int node)
+    {
+        const auto page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        if (node < 0 || node >= static_cast<int>(sizeof(unsigned long) * CHAR_BIT) ||
+            reinterpret_cast<std::uintptr_t>(addr) % page != 0 || bytes % page != 0)
+        {
+            return false;
+        }
+        unsigned long mask = 1UL << static_cast<unsigned>(node);
+        return syscall(SYS_mbind, addr, bytes, MPOL_PREFERRED, &mask, sizeof(mask) * CHAR_BIT, 0) == 0;
+    }
+
+    NumaFractionArray::NumaFractionArray(std::size_t size, unsigned threads) : count(size)
+    {
+        const std::vector<std::pair<int, int>> cpus = allowed_cpus();
+        const std::size_t blocks = (size + PARALLEL_BLOCK - 1) / PARALLEL_BLOCK;
+        std::size_t parts = threads == 0 ? cpus.size() : threads;
+        parts = std::clamp<std::size_t>(parts, 1, std::max<std::size_t>(blocks, 1));
+
+        // Whole blocks per partition, so a partition boundary is also a block boundary
+        for (std::size_t i = 0; i < parts; ++i)
+        {
+            NumaPartitionInfo info;
+            info.node = cpus[i % cpus.size()].first;
+            info.cpu = cpus[i % cpus.size()].second;
+            info.begin = std::min(size, blocks * i / parts * PARALLEL_BLOCK);
+            info.end = std::min(size, blocks * (i + 1) / parts * PARALLEL_BLOCK);
+            infos.push_back(info);
+        }
+
+        if (size > 0)
+        {
+            mapped_bytes = blocks * PARALLEL_BLOCK * sizeof(Fraction);
+            void *mapping = mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mapping == MAP_FAILED)
+            {
+                throw std::bad_alloc();
+            }
+            elements = static_cast<Fraction *>(mapping);
+            for (NumaPartitionInfo &info : infos)
+            {
+                const std::size_t first_block = info.begin / PARALLEL_BLOCK;
+                const std::size_t last_block = (info.end + PARALLEL_BLOCK - 1) / PARALLEL_BLOCK;
+                info.bound = bind_to_node(elements + first_block * PARALLEL_BLOCK,
+                                          (last_block - first_block) * PARALLEL_BLOCK * sizeof(Fraction), info.node);
+            }
+        }
+
+        try
+        {
+            for (std::size_t i = 0; i < parts; ++i)
+            {
+                workers.push_back(std::make_unique<Worker>());
+            }
+            for (std::size_t i = 0; i < parts; ++i)
+            {
+                workers[i]->thread = std::thread(&NumaFractionArray::serve, this, i);
+            }
+            // First touch: each partition's pages are faulted in by its own pinned worker
+            for_each_partition([](std::size_t, std::span<Fraction> part)
+                               { std::uninitialized_default_construct(part.begin(), part.end()); });
+        }
+        catch (...)
+        {
+            stop_workers();
+            if (elements != nullptr)
+            {
+                munmap(elements, mapped_bytes);
+            }
+            throw;
+        }
+    }
+
+    NumaFractionArray::~NumaFractionArray()
+    {
+        stop_workers();
+        if (elements != nullptr)
+        {
+            munmap(elements, mapped_bytes);
+        }
+    }
+
+    void NumaFractionArray::stop_workers()
+    {
+        for (std::unique_ptr<Worker> &worker : workers)
+        {
+            {
+                std::lock_guard<std::mutex> guard(worker->lock);
+                worker->stopping = true;
+            }
+            worker->wake.notify_one();
+            if (worker->thread.joinable())
+            {
+                worker->thread.join();
+            }
+        }
+        workers.clear();
+    }
+
+    void NumaFractionArray::serve(std::size_t index)
+    {
+        NumaPartitionInfo &info = infos[index];
+        if (info.cpu >= 0)
+        {
+            cpu_set_t only;
+            CPU_ZERO(&only);
+            CPU_SET(static_cast<std::size_t>(info.cpu), &only);
+            info.pinned = sched_setaffinity(0, sizeof(only), &only) == 0;
+        }
+        Worker &worker = *workers[index];
+        while (true)
+        {
+            const std::function<void(std::size_t)> *job = nullptr;
+            {
+                std::unique_lock<std::mutex> guard(worker.lock);
+                worker.wake.wait(guard, [&worker]
+                                 { return worker.stopping || worker.job != nullptr; });
+                if (worker.job == nullptr)
+                {
+                    return;
+                }
+                job = std::exchange(worker.job, nullptr);
+            }
+            try
+            {
+                (*job)(index);
+            }
+            catch (...)
+            {
+                worker.error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> guard(done_lock);
+            if (--running == 0)
+            {
+                done.notify_all();
+            }
+        }
+    }
+
+    void NumaFractionArray::run_on_workers(const std::function<void(std::size_t)> &job)
+    {
+        std::lock_guard<std::mutex> batch(batch_lock);
+        {
+            std::lock_guard<std::mutex> guard(done_lock);
+            running = workers.size();
+        }
+        for (std::unique_ptr<Worker> &worker : workers)
+        {
+            {
+                std::lock_guard<std::mutex> guard(worker->lock);
+                worker->job = &job;
+                worker->error = nullptr;
+            }
+            worker->wake.notify_one();
+        }
+        {
+            std::unique_lock<std::mutex> guard(done_lock);
+            done.wait(guard, [this]
+                      { return running == 0; });
+        }
+        for (std::unique_ptr<Worker> &worker : workers)
+        {
+            if (worker->error)
+            {
+                std::rethrow_exception(std::exchange(worker->error, nullptr));
+            }
+        }
+    }
+
+    std::span<Fraction> NumaFractionArray::partition(std::size_t index)
+    {
+        const NumaPartitionInfo &info = infos[index];
+        return {elements + info.begin, info.end - info.begin};
+    }
+
+    const NumaPartitionInfo &NumaFractionArray::partition_info(std::size_t index) const
+    {
+        return infos[index];
+    }
+
+    void NumaFractionArray::for_each_partition(const std::function<void(std::size_t, std::span<Fraction>)> &func)
+    {
+        run_on_workers([&](std::size_t index)
+                       { func(index, partition(index)); });
+    }
+
+    BlockScheduler NumaFractionArray::scheduler()
+    {
+        return [this](std::size_t tasks, const std::function<void(std::size_t)> &task)
+        {
+            run_on_workers([&](std::size_t index)
+                           {
+                // Blocks past the array (a longer span) go to the last worker
+                const std::size_t first = infos[index].begin / PARALLEL_BLOCK;
+                const std::size_t last = index + 1 == infos.size() ? tasks : infos[index + 1].begin / PARALLEL_BLOCK;
+                for (std::size_t block = first; block < std::min(last, tasks); ++block)
+                {
+                    task(block);
+                } });
+        };
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "Fraction.hpp"
+#include "FractionParallel.hpp"
+
+namespace ariel
+{
+    // Where one partition of a NumaFractionArray lives and is processed
+    struct NumaPartitionInfo
+    {
+        int cpu = -1;          // CPU its worker is pinned to
+        int node = 0;          // memory node of that CPU (0 without NUMA information)
+        bool pinned = false;   // sched_setaffinity succeeded
+        bool bound = false;    // mbind succeeded for its pages
+        std::size_t begin = 0; // element range [begin, end)
+        std::size_t end = 0;
+    };
+
+    // Fixed-size Fraction array split into contiguous partitions, one per pinned worker,
+    // so a scan over it reads only node-local memory. The array is one anonymous mapping;
+    // each partition starts on a PARALLEL_BLOCK (and page) boundary, is bound to its
+    // worker's node with mbind(MPOL_PREFERRED), and is first-touched by that worker.
+    // Only raw syscalls and /sys are used (no libnuma): on a host without NUMA, or where
+    // mbind or pinning is refused, everything still works with the kernel's default
+    // placement and the flags in partition_info() say what took effect.
+    class NumaFractionArray
+    {
+    public:
+        // Elements are 0/1. threads: workers (and partitions), 0 for one per CPU the process
+        // may run on; capped at one per PARALLEL_BLOCK elements
+        explicit NumaFractionArray(std::size_t size, unsigned threads = 0);
+        ~NumaFractionArray();
+
+        NumaFractionArray(const NumaFractionArray &) = delete;
+        NumaFractionArray &operator=(const NumaFractionArray &) = delete;
+
+        std::size_t size() const { return count; }
+        std::span<Fraction> data() { return {elements, count}; }
+        std::span<const Fraction> data() const { return {elements, count}; }
+        Fraction &operator[](std::size_t index) { return elements[index]; }
+        const Fraction &operator[](std::size_t index) const { return elements[index]; }
+
+        std::size_t partitions() const { return infos.size(); }
+        std::span<Fraction> partition(std::size_t index);
+        const NumaPartitionInfo &partition_info(std::size_t index) const;
+
+        // Runs func(index, partition) for every partition on its pinned worker and waits.
+        // Rethrows the exception of the lowest failing partition.
+        void for_each_partition(const std::function<void(std::size_t, std::span<Fraction>)> &func);
+
+        // Scheduler for the parallel algorithms over data(): block b runs on the worker
+        // whose partition holds it, e.g. parallel_sum(array.data(), array.scheduler()).
+        // The array must outlive the scheduler.
+        BlockScheduler scheduler();
+
+    private:
+        struct Worker
+        {
+            std::mutex lock;
+            std::condition_variable wake;
+            const std::function<void(std::size_t)> *job = nullptr;
+            std::exception_ptr error;
+            bool stopping = false;
+            std::thread thread;
+        };
+
+        void serve(std::size_t index);
+        void stop_workers();
+        // Runs job(i) on worker i for every worker and waits for all of them
+        void run_on_workers(const std::function<void(std::size_t)> &job);
+
+        Fraction *elements = nullptr;
+        std::size_t count = 0;
+        std::size_t mapped_bytes = 0;
+        std::vector<NumaPartitionInfo> infos;
+        std::vector<std::unique_ptr<Worker>> workers;
+
+        // One run_on_workers at a time
+        std::mutex batch_lock;
+        std::mutex done_lock;
+        std::condition_variable done;
+        std::size_t running = 0;
+    };
+}
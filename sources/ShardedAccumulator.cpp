@@ -0,0 +1,203 @@
+#include "ShardedAccumulator.hpp"
+#include "FractionMath.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+namespace ariel
+{
+    using Wide = __int128;
+
+    // Shard index of the calling thread. Indices are handed out smallest-free-first and
+    // given back when the thread exits, so they stay dense among live threads however many
+    // threads come and go; the mutex is only taken at thread start and exit. A recycled
+    // index continues the previous owner's shard, which is safe since that thread is gone
+    // and the free list orders its last writes before the new owner's first.
+    class ThreadSlot
+    {
+    public:
+        ThreadSlot()
+        {
+            std::lock_guard<std::mutex> guard(lock());
+            std::vector<std::size_t> &idle = free_list();
+            if (idle.empty())
+            {
+                index = next()++;
+                return;
+            }
+            auto smallest = std::min_element(idle.begin(), idle.end());
+            index = *smallest;
+            idle.erase(smallest);
+        }
+        ~ThreadSlot()
+        {
+            std::lock_guard<std::mutex> guard(lock());
+            free_list().push_back(index);
+        }
+        ThreadSlot(const ThreadSlot &) = delete;
+        ThreadSlot &operator=(const ThreadSlot &) = delete;
+
+        std::size_t index = 0;
+
+    private:
+        static std::mutex &lock()
+        {
+            static std::mutex mutex;
+            return mutex;
+        }
+        static std::vector<std::size_t> &free_list()
+        {
+            static std::vector<std::size_t> indices;
+            return indices;
+        }
+        static std::size_t &next()
+        {
+            static std::size_t counter = 0;
+            return counter;
+        }
+    };
+
+    static std::size_t thread_index()
+    {
+        thread_local const ThreadSlot slot;
+        return slot.index;
+    }
+
+    ShardedAccumulator::ShardedAccumulator(std::size_t shards)
+        : count(shards == 0 ? 1 : shards), shards(std::make_unique<Shard[]>(count)) {}
+
+    void ShardedAccumulator::add_to(Shard &shard, const Fraction &value)
+    {
+        int64_t num = value.getNumerator();
+        int64_t den = value.getDenominator();
+        if (den < 0)
+        {
+            num = -num;
+            den = -den;
+        }
+        int64_t lcm = shard.lcm.load(std::memory_order_relaxed);
+        int64_t total = shard.num.load(std::memory_order_relaxed);
+
+        // Rescale to a common denominator; only the new prime factors of den grow the lcm
+        auto scale = static_cast<int64_t>(static_cast<uint64_t>(den) / binary_gcd(static_cast<uint64_t>(lcm), static_cast<uint64_t>(den)));
+        int64_t term = 0;
+        if (__builtin_mul_overflow(lcm, scale, &lcm) ||
+            __builtin_mul_overflow(total, scale, &total) ||
+            __builtin_mul_overflow(num, lcm / den, &term) ||
+            __builtin_add_overflow(total, term, &total))
+        {
+            throw std::overflow_error("Overflow in ShardedAccumulator shard");
+        }
+        if (scale != 1)
+        {
+            // Keep the shard small: cancel whatever the numerator shares with the lcm
+            auto gcd_ = static_cast<int64_t>(binary_gcd(magnitude(total), static_cast<uint64_t>(lcm)));
+            lcm /= gcd_;
+            total /= gcd_;
+        }
+
+        // Single writer seqlock: odd sequence while the pair is being replaced
+        uint64_t seq = shard.seq.load(std::memory_order_relaxed);
+        shard.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        shard.lcm.store(lcm, std::memory_order_relaxed);
+        shard.num.store(total, std::memory_order_relaxed);
+        shard.seq.store(seq + 2, std::memory_order_release);
+    }
+
+    void ShardedAccumulator::snapshot(const Shard &shard, int64_t &lcm, int64_t &num)
+    {
+        while (true)
+        {
+            uint64_t before = shard.seq.load(std::memory_order_acquire);
+            lcm = shard.lcm.load(std::memory_order_relaxed);
+            num = shard.num.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if ((before & 1U) == 0 && shard.seq.load(std::memory_order_relaxed) == before)
+            {
+                return;
+            }
+        }
+    }
+
+    void ShardedAccumulator::add(const Fraction &value)
+    {
+        std::size_t index = thread_index();
+        if (index < count)
+        {
+            add_to(shards[index], value);
+            return;
+        }
+        std::lock_guard<std::mutex> guard(spill_lock);
+        ++spill_count;
+        add_to(spill, value);
+    }
+
+    Fraction ShardedAccumulator::read() const
+    {
+        Wide lcm = 1;
+        Wide total = 0;
+        auto merge = [&](const Shard &shard)
+        {
+            int64_t shard_lcm = 1;
+            int64_t shard_num = 0;
+            snapshot(shard, shard_lcm, shard_num);
+            if (shard_num == 0)
+            {
+                return;
+            }
+            // Both lcms are below 2^63, so the common denominator is kept in 128 bits
+            Wide gcd_ = 0;
+            for (Wide num_a = lcm, num_b = shard_lcm; num_b != 0;)
+            {
+                Wide rest = num_a % num_b;
+                num_a = num_b;
+                num_b = rest;
+                gcd_ = num_a;
+            }
+            Wide scale = shard_lcm / gcd_;
+            Wide scaled = 0;
+            Wide term = 0;
+            if (__builtin_mul_overflow(lcm, scale, &lcm) ||
+                __builtin_mul_overflow(total, scale, &scaled) ||
+                __builtin_mul_overflow(static_cast<Wide>(shard_num), lcm / shard_lcm, &term) ||
+                __builtin_add_overflow(scaled, term, &total))
+            {
+                throw std::overflow_error("Overflow in ShardedAccumulator read");
+            }
+        };
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            merge(shards[i]);
+        }
+        merge(spill);
+
+        Wide num_a = total < 0 ? -total : total;
+        Wide num_b = lcm;
+        while (num_b != 0)
+        {
+            Wide rest = num_a % num_b;
+            num_a = num_b;
+            num_b = rest;
+        }
+        total /= num_a;
+        lcm /= num_a;
+        if (total > INT32_MAX || total < -INT32_MAX || lcm > INT32_MAX)
+        {
+            throw std::overflow_error("ShardedAccumulator total does not fit in a Fraction");
+        }
+        return Fraction::from_reduced(static_cast<int>(total), static_cast<int>(lcm));
+    }
+
+    uint64_t ShardedAccumulator::spilled() const
+    {
+        std::lock_guard<std::mutex> guard(spill_lock);
+        return spill_count;
+    }
+
+    std::size_t ShardedAccumulator::shard_count() const
+    {
+        return count;
+    }
+}
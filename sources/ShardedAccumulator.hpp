@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "Fraction.hpp"
+
+namespace ariel
+{
+    // Shared rational counter split into cache-line-sized per-thread shards. Each shard is
+    // a running sum num/lcm with a single writer, so add() is plain loads and stores (a
+    // seqlock lets readers take a consistent snapshot) with no atomic read-modify-write.
+    // read() puts all shards over their common denominator in 128 bits and reduces once.
+    class ShardedAccumulator
+    {
+    public:
+        // Each live thread owns one shard; indices are recycled when threads exit, so only
+        // more than `shards` simultaneously live threads share the mutex-protected spill shard
+        explicit ShardedAccumulator(std::size_t shards = DEFAULT_SHARDS);
+
+        // std::overflow_error if the calling thread's shard would overflow (shard unchanged)
+        void add(const Fraction &value);
+        // std::overflow_error if the merged total does not fit in a Fraction
+        Fraction read() const;
+
+        std::size_t shard_count() const;
+        // Updates that went to the spill shard
+        uint64_t spilled() const;
+
+        static constexpr std::size_t DEFAULT_SHARDS = 64;
+
+    private:
+        struct alignas(64) Shard
+        {
+            std::atomic<uint64_t> seq{0};
+            std::atomic<int64_t> lcm{1};
+            std::atomic<int64_t> num{0};
+        };
+
+        static void add_to(Shard &shard, const Fraction &value);
+        static void snapshot(const Shard &shard, int64_t &lcm, int64_t &num);
+
+        std::size_t count;
+        std::unique_ptr<Shard[]> shards;
+        Shard spill;
+        mutable std::mutex spill_lock;
+        uint64_t spill_count = 0;
+    };
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <climits>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+
+#include "Fraction.hpp"
+#include "FractionMath.hpp"
+
+namespace ariel
+{
+    // Error bits of the non-throwing arithmetic paths; combine with | and test with &
+    enum class FractionStatus : uint8_t
+    {
+        OK = 0,
+        OVERFLOWED = 1,
+        DIVIDED_BY_ZERO = 2
+    };
+
+    constexpr FractionStatus operator|(FractionStatus lhs, FractionStatus rhs) noexcept
+    {
+        return static_cast<FractionStatus>(static_cast<uint8_t>(lhs) | static_cast<uint8_t>(rhs));
+    }
+
+    constexpr bool operator&(FractionStatus lhs, FractionStatus rhs) noexcept
+    {
+        return (static_cast<uint8_t>(lhs) & static_cast<uint8_t>(rhs)) != 0;
+    }
+
+    // Fraction arithmetic that never throws, for std::execution::par_unseq and other
+    // contexts where an exception terminates. Errors set sticky flags instead, which like a
+    // floating-point NaN propagate through every later operation, so a whole reduction can
+    // be checked once at the end. The value of a failed result is 0/1.
+    // Inline so unsequenced loops can inline it.
+    class StickyFraction
+    {
+    public:
+        StickyFraction() noexcept = default;
+        StickyFraction(const Fraction &fraction) noexcept
+            : numerator(fraction.getNumerator()), denominator(fraction.getDenominator())
+        {
+            if (denominator < 0 || numerator == INT_MIN)
+            {
+                // Unreduced or out-of-range terms; keep den > 0 and |num| <= INT_MAX so the
+                // 64-bit cross products below cannot overflow
+                *this = make(numerator, denominator);
+            }
+        }
+        // DIVIDED_BY_ZERO for den == 0, OVERFLOWED if the reduced terms do not fit
+        static StickyFraction make(int64_t num, int64_t den) noexcept
+        {
+            if (den == 0)
+            {
+                return failed(FractionStatus::DIVIDED_BY_ZERO);
+            }
+            if (den < 0)
+            {
+                num = -num;
+                den = -den;
+            }
+            StickyFraction result;
+            if (!reduce_to_int(num, den, result.numerator, result.denominator))
+            {
+                return failed(FractionStatus::OVERFLOWED);
+            }
+            return result;
+        }
+
+        friend StickyFraction operator+(const StickyFraction &lhs, const StickyFraction &rhs) noexcept
+        {
+            StickyFraction result = make(static_cast<int64_t>(lhs.numerator) * rhs.denominator + static_cast<int64_t>(rhs.numerator) * lhs.denominator,
+                                         static_cast<int64_t>(lhs.denominator) * rhs.denominator);
+            return result.with(lhs.flags | rhs.flags);
+        }
+        friend StickyFraction operator-(const StickyFraction &lhs, const StickyFraction &rhs) noexcept
+        {
+            StickyFraction result = make(static_cast<int64_t>(lhs.numerator) * rhs.denominator - static_cast<int64_t>(rhs.numerator) * lhs.denominator,
+                                         static_cast<int64_t>(lhs.denominator) * rhs.denominator);
+            return result.with(lhs.flags | rhs.flags);
+        }
+        friend StickyFraction operator*(const StickyFraction &lhs, const StickyFraction &rhs) noexcept
+        {
+            StickyFraction result = make(static_cast<int64_t>(lhs.numerator) * rhs.numerator,
+                                         static_cast<int64_t>(lhs.denominator) * rhs.denominator);
+            return result.with(lhs.flags | rhs.flags);
+        }
+        friend StickyFraction operator/(const StickyFraction &lhs, const StickyFraction &rhs) noexcept
+        {
+            StickyFraction result = make(static_cast<int64_t>(lhs.numerator) * rhs.denominator,
+                                         static_cast<int64_t>(lhs.denominator) * rhs.numerator);
+            return result.with(lhs.flags | rhs.flags);
+        }
+        StickyFraction &operator+=(const StickyFraction &other) noexcept { return *this = *this + other; }
+        StickyFraction &operator-=(const StickyFraction &other) noexcept { return *this = *this - other; }
+        StickyFraction &operator*=(const StickyFraction &other) noexcept { return *this = *this * other; }
+        StickyFraction &operator/=(const StickyFraction &other) noexcept { return *this = *this / other; }
+
+        FractionStatus status() const noexcept { return flags; }
+        bool ok() const noexcept { return flags == FractionStatus::OK; }
+        int getNumerator() const noexcept { return numerator; }
+        int getDenominator() const noexcept { return denominator; }
+
+        // Non-throwing conversion back; false (out untouched) if any error flag is set
+        bool get(Fraction &out) const noexcept
+        {
+            if (!ok())
+            {
+                return false;
+            }
+            out = Fraction::from_reduced(numerator, denominator);
+            return true;
+        }
+        // Throws what the Fraction operators would have: std::runtime_error for a division
+        // by zero, std::overflow_error otherwise
+        Fraction value() const
+        {
+            if (flags & FractionStatus::DIVIDED_BY_ZERO)
+            {
+                throw std::runtime_error("Division by zero");
+            }
+            if (flags & FractionStatus::OVERFLOWED)
+            {
+                throw std::overflow_error("Overflow in StickyFraction arithmetic");
+            }
+            return Fraction::from_reduced(numerator, denominator);
+        }
+
+        // Exact equality of value and flags
+        bool operator==(const StickyFraction &other) const noexcept = default;
+
+    private:
+        static StickyFraction failed(FractionStatus status) noexcept
+        {
+            StickyFraction result;
+            result.flags = status;
+            return result;
+        }
+        StickyFraction with(FractionStatus inherited) const noexcept
+        {
+            return inherited == FractionStatus::OK ? *this : failed(flags | inherited);
+        }
+
+        int numerator = 0;
+        int denominator = 1;
+        FractionStatus flags = FractionStatus::OK;
+    };
+
+    static_assert(std::is_trivially_copyable_v<StickyFraction> && std::is_standard_layout_v<StickyFraction>,
+                  "StickyFraction must stay usable as plain data in parallel algorithms");
+}